@@ -0,0 +1,133 @@
+/*
+ */
+#include <mbgl/util/logging.hpp>
+#include <mbgl/util/platform.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+
+#include "AccessLog.hpp"
+
+namespace alk {
+
+AccessLog& AccessLog::get() {
+	static AccessLog log;
+	return log;
+}
+
+AccessLog::~AccessLog() {
+	if (!thread.joinable()) {
+		return;
+	}
+	verbosity.store(Verbosity::Off, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		terminating = true;
+	}
+	wake.notify_one();
+	thread.join();
+}
+
+void AccessLog::configure(Verbosity verbosity_, std::size_t capacity, std::chrono::milliseconds flushInterval_) {
+	if (thread.joinable()) {
+		throw std::logic_error("AccessLog is already configured");
+	}
+	if (verbosity_ == Verbosity::Off) {
+		return;
+	}
+
+	std::size_t size = 1;
+	while (size < capacity) {
+		size <<= 1;
+	}
+	slots = std::make_unique<Slot[]>(size);
+	for (std::size_t i = 0; i < size; i++) {
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	mask = size - 1;
+	flushInterval = flushInterval_;
+	thread = std::thread([this] () { run(); });
+	verbosity.store(verbosity_, std::memory_order_release);
+}
+
+AccessLog::Verbosity AccessLog::parseVerbosity(const std::string& name) {
+	if (name == "off") {
+		return Verbosity::Off;
+	} else if (name == "requests") {
+		return Verbosity::Requests;
+	} else if (name == "trace") {
+		return Verbosity::Trace;
+	}
+	throw std::invalid_argument("Log level must be off, requests or trace");
+}
+
+void AccessLog::write(mbgl::EventSeverity severity, mbgl::Event event, std::string line) {
+	if (verbosity.load(std::memory_order_acquire) == Verbosity::Off) {
+		return;
+	}
+
+	// A bounded multi-producer queue: a slot is free for the writer at
+	// position pos once its sequence equals pos, and readable once it is
+	// pos + 1.
+	std::size_t pos = head.load(std::memory_order_relaxed);
+	Slot* slot;
+	while (true) {
+		slot = &slots[pos & mask];
+		const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		const auto difference = static_cast<std::ptrdiff_t>(sequence - pos);
+		if (difference == 0) {
+			if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (difference < 0) {
+			// The ring is full; the flushing thread is behind.
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		} else {
+			pos = head.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->severity = severity;
+	slot->event = event;
+	slot->line = std::move(line);
+	slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void AccessLog::drain() {
+	while (true) {
+		Slot& slot = slots[tail & mask];
+		if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+			break;
+		}
+		const mbgl::EventSeverity severity = slot.severity;
+		const mbgl::Event event = slot.event;
+		std::string line = std::move(slot.line);
+		slot.line.clear();
+		slot.sequence.store(tail + mask + 1, std::memory_order_release);
+		tail++;
+
+		mbgl::Log::Record(severity, event, line);
+	}
+
+	const uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+	if (lost) {
+		mbgl::Log::Warning(mbgl::Event::General, "Access log dropped " + std::to_string(lost) + " lines");
+	}
+}
+
+void AccessLog::run() {
+	mbgl::platform::setCurrentThreadName("Access Log");
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!terminating) {
+		wake.wait_for(lock, flushInterval);
+		lock.unlock();
+		drain();
+		lock.lock();
+	}
+	lock.unlock();
+	drain();
+}
+
+}
@@ -0,0 +1,93 @@
+/*
+ */
+#pragma once
+
+#include <mbgl/util/event.hpp>
+#include <mbgl/util/noncopyable.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace alk {
+
+/**
+ * A process-wide, asynchronous log for the tile serving hot path.
+ *
+ * Threads append lines to a bounded lock-free ring buffer and never block on
+ * IO; when the ring is full the line is dropped and counted. A background
+ * thread drains the ring and hands the lines to mbgl::Log, so they end up
+ * wherever the platform or the installed Log::Observer sends them.
+ */
+class AccessLog : private mbgl::util::noncopyable {
+public:
+	enum class Verbosity : uint8_t {
+		Off,
+		// One line per request, with its status, size, cache outcome and timing.
+		Requests,
+		// Also every cache lookup, render, encode and cache write.
+		Trace,
+	};
+
+	static AccessLog& get();
+
+	// Starts the flushing thread. Must be called once, before any line is
+	// written; until then, nothing is logged.
+	void configure(Verbosity, std::size_t capacity = 8192,
+			std::chrono::milliseconds flushInterval = std::chrono::milliseconds(200));
+
+	// Throws std::invalid_argument for anything but off, requests and trace.
+	static Verbosity parseVerbosity(const std::string&);
+
+	bool logging(Verbosity level) const {
+		return level != Verbosity::Off && level <= verbosity.load(std::memory_order_relaxed);
+	}
+	bool tracing() const {
+		return logging(Verbosity::Trace);
+	}
+
+	// Thread safe and lock-free.
+	void request(std::string line) {
+		write(mbgl::EventSeverity::Info, mbgl::Event::HttpRequest, std::move(line));
+	}
+	void trace(mbgl::Event event, std::string line) {
+		write(mbgl::EventSeverity::Info, event, std::move(line));
+	}
+	void write(mbgl::EventSeverity, mbgl::Event, std::string line);
+
+private:
+	AccessLog() = default;
+	// Flushes the remaining lines.
+	~AccessLog();
+
+	struct Slot {
+		std::atomic<std::size_t> sequence { 0 };
+		mbgl::EventSeverity severity;
+		mbgl::Event event;
+		std::string line;
+	};
+
+	void run();
+	// Only called from the flushing thread.
+	void drain();
+
+	std::atomic<Verbosity> verbosity { Verbosity::Off };
+	std::unique_ptr<Slot[]> slots;
+	std::size_t mask = 0;
+	std::atomic<std::size_t> head { 0 };
+	std::size_t tail = 0;
+	std::atomic<uint64_t> dropped { 0 };
+
+	std::chrono::milliseconds flushInterval { 0 };
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool terminating = false;
+	std::thread thread;
+};
+
+}
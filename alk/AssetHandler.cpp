@@ -0,0 +1,130 @@
+/*
+ */
+#include "AssetHandler.hpp"
+#include "AccessLog.hpp"
+#include "SharedIOBuf.hpp"
+
+#include <folly/io/IOBuf.h>
+#include <folly/io/async/EventBaseManager.h>
+#include <mbgl/util/chrono.hpp>
+#include <proxygen/httpserver/RequestHandler.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace proxygen;
+
+namespace alk {
+
+namespace {
+
+bool isGzipped(const std::string& data) {
+  return data.size() > 2 && uint8_t(data[0]) == 0x1F && uint8_t(data[1]) == 0x8B;
+}
+
+} // namespace
+
+AssetHandler::AssetHandler(AssetSource* assets_, const TileRouter::Match& route) :
+				assets(assets_),
+				resource_(assets_->resource(route)),
+				contentType_(route.format == TileRouter::Format::JSON ? "application/json" :
+						route.format == TileRouter::Format::PNG ? "image/png" : "application/x-protobuf") {
+}
+
+void AssetHandler::onRequest(std::unique_ptr<HTTPMessage> headers) noexcept {
+  begin_ = std::chrono::steady_clock::now();
+  request_ = std::move(headers);
+}
+
+void AssetHandler::onBody(std::unique_ptr<folly::IOBuf> /*body*/) noexcept {
+  // Assets are only ever read.
+}
+
+void AssetHandler::onEOM() noexcept {
+  if (!resource_) {
+	  ResponseBuilder(downstream_)
+	  	  .status(404, "Not Found")
+		  .sendWithEOM();
+	  logRequest(404, 0);
+	  return;
+  }
+  // The file source answers on the asset thread; the response is posted
+  // back to our EventBase.
+  folly::EventBase* evb = folly::EventBaseManager::get()->getEventBase();
+  pending = true;
+  assets->fetch(*resource_, [this, evb] (mbgl::Response response) {
+	  auto shared = std::make_shared<mbgl::Response>(std::move(response));
+	  evb->runInEventBaseThread([this, shared] () {
+		  onLoaded(std::move(*shared));
+	  });
+  });
+}
+
+void AssetHandler::onLoaded(mbgl::Response response) noexcept {
+  pending = false;
+  if (aborted) {
+	  delete this;
+	  return;
+  }
+  if (response.data && !response.noContent) {
+	  ResponseBuilder builder(downstream_);
+	  builder.status(200, "OK")
+		  .header("Content-Type", contentType_);
+	  if (isGzipped(*response.data)) {
+		  builder.header("Content-Encoding", "gzip");
+	  }
+	  if (response.expires && *response.expires > mbgl::util::now()) {
+		  const auto maxAge = std::chrono::duration_cast<mbgl::Seconds>(*response.expires - mbgl::util::now());
+		  builder.header("Cache-Control", "max-age=" + std::to_string(maxAge.count()));
+	  }
+	  builder.body(wrapShared(response.data))
+		  .sendWithEOM();
+	  logRequest(200, response.data->size());
+  } else if (response.noContent || (response.error && response.error->reason == mbgl::Response::Error::Reason::NotFound)) {
+	  ResponseBuilder(downstream_)
+		  .status(404, "Not Found")
+		  .sendWithEOM();
+	  logRequest(404, 0);
+  } else {
+	  ResponseBuilder(downstream_)
+		  .status(502, "Bad Gateway")
+		  .sendWithEOM();
+	  logRequest(502, 0);
+  }
+}
+
+void AssetHandler::logRequest(uint16_t status, std::size_t bytes) noexcept {
+  auto& accessLog = AccessLog::get();
+  if (!accessLog.logging(AccessLog::Verbosity::Requests)) {
+	  return;
+  }
+  const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin_;
+  std::ostringstream line;
+  line << "method=" << (request_ ? request_->getMethodString() : "-")
+	   << " url=" << (request_ ? request_->getURL() : "-")
+	   << " status=" << status
+	   << " bytes=" << bytes
+	   << " ms=" << elapsed.count();
+  accessLog.request(line.str());
+}
+
+void AssetHandler::onUpgrade(UpgradeProtocol /*protocol*/) noexcept {
+  // handler doesn't support upgrades
+}
+
+void AssetHandler::requestComplete() noexcept {
+  delete this;
+}
+
+void AssetHandler::onError(ProxygenError /*err*/) noexcept {
+	if (pending) {
+		// The asset thread still references us; onLoaded will clean up
+		// when the response arrives.
+		aborted = true;
+		return;
+	}
+	delete this;
+}
+
+}
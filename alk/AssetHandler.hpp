@@ -0,0 +1,60 @@
+/*
+ */
+#pragma once
+
+#include <folly/Memory.h>
+#include <folly/io/async/EventBase.h>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/optional.hpp>
+#include <proxygen/httpserver/RequestHandler.h>
+#include <chrono>
+#include <memory>
+
+#include "AssetSource.hpp"
+#include "TileRouter.hpp"
+
+namespace proxygen {
+class ResponseHandler;
+}
+
+namespace alk {
+
+/**
+ * Responds to /vector, /fonts and /sprites with the bytes the file source
+ * has for them, as they are stored. Gzipped vector tiles and glyphs are sent
+ * with Content-Encoding: gzip.
+ */
+class AssetHandler : public proxygen::RequestHandler {
+ public:
+  AssetHandler(AssetSource* assets_, const TileRouter::Match& route);
+
+  void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers)
+      noexcept override;
+
+  void onBody(std::unique_ptr<folly::IOBuf> body) noexcept override;
+
+  void onEOM() noexcept override;
+
+  void onUpgrade(proxygen::UpgradeProtocol proto) noexcept override;
+
+  void requestComplete() noexcept override;
+
+  void onError(proxygen::ProxygenError err) noexcept override;
+
+ private:
+  // Called on the EventBase thread with the file source's response.
+  void onLoaded(mbgl::Response response) noexcept;
+
+  void logRequest(uint16_t status, std::size_t bytes) noexcept;
+
+  AssetSource* assets;
+  mbgl::optional<mbgl::Resource> resource_;
+  const char* contentType_;
+  std::unique_ptr<proxygen::HTTPMessage> request_;
+  std::chrono::steady_clock::time_point begin_;
+  bool pending = false;
+  bool aborted = false;
+};
+
+}
@@ -0,0 +1,107 @@
+/*
+ */
+#include <mbgl/util/font_stack.hpp>
+#include <mbgl/util/platform.hpp>
+#include <mbgl/util/run_loop.hpp>
+#include <mbgl/util/url.hpp>
+
+#include <future>
+
+#include "AssetSource.hpp"
+
+namespace alk {
+
+AssetSource::AssetSource(mbgl::FileSource& fileSource_, Options options_)
+	: fileSource(fileSource_),
+	  options(std::move(options_)) {
+	std::promise<void> running;
+
+	thread = std::thread([&] () {
+		mbgl::platform::setCurrentThreadName("Assets");
+
+		mbgl::util::RunLoop loop_(mbgl::util::RunLoop::Type::New);
+		loop = &loop_;
+		running.set_value();
+
+		loop->run();
+		loop = nullptr;
+	});
+
+	running.get_future().get();
+}
+
+AssetSource::~AssetSource() {
+	std::promise<void> cancelled;
+
+	// The requests must be released on the thread that made them.
+	loop->invoke([&] () {
+		requests.clear();
+		cancelled.set_value();
+	});
+
+	cancelled.get_future().get();
+
+	loop->stop();
+	thread.join();
+}
+
+mbgl::optional<mbgl::Resource> AssetSource::resource(const TileRouter::Match& route) const {
+	switch (route.endpoint) {
+	case TileRouter::Endpoint::VectorTile: {
+		auto source = options.vectorSources.find(route.styleName());
+		if (source == options.vectorSources.end()) {
+			return {};
+		}
+		return mbgl::Resource::tile(source->second, 1.0, route.x, route.y, route.zoom,
+				mbgl::Tileset::Scheme::XYZ);
+	}
+	case TileRouter::Endpoint::Glyphs: {
+		if (options.glyphs.empty()) {
+			return {};
+		}
+		// Resource::glyphs encodes the stack again.
+		mbgl::FontStack stack;
+		const std::string fonts = mbgl::util::percentDecode(route.styleName());
+		std::size_t begin = 0;
+		while (true) {
+			const std::size_t comma = fonts.find(',', begin);
+			stack.push_back(fonts.substr(begin, comma - begin));
+			if (comma == std::string::npos) {
+				break;
+			}
+			begin = comma + 1;
+		}
+		return mbgl::Resource::glyphs(options.glyphs, stack,
+				{ uint16_t(route.glyphs), uint16_t(route.glyphs + 255) });
+	}
+	case TileRouter::Endpoint::Sprite: {
+		auto sprite = options.sprites.find(route.styleName());
+		if (sprite == options.sprites.end()) {
+			return {};
+		}
+		if (route.format == TileRouter::Format::JSON) {
+			return mbgl::Resource::spriteJSON(sprite->second, route.scale);
+		}
+		return mbgl::Resource::spriteImage(sprite->second, route.scale);
+	}
+	default:
+		return {};
+	}
+}
+
+void AssetSource::fetch(mbgl::Resource resource, Callback callback) {
+	loop->invoke([this, resource, callback] () {
+		const uint64_t id = nextRequest++;
+		// Cached resources are answered first; we don't wait for them to be
+		// revalidated, which the renderers take care of.
+		requests[id] = fileSource.request(resource, [this, id, callback] (mbgl::Response response) {
+			// Releasing the request destroys this lambda, so copy what we need first.
+			const uint64_t request = id;
+			Callback done = callback;
+			requests.erase(request);
+			done(std::move(response));
+		});
+	});
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+ */
+#pragma once
+
+#include <mbgl/storage/file_source.hpp>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/noncopyable.hpp>
+#include <mbgl/util/optional.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "TileRouter.hpp"
+
+namespace mbgl {
+namespace util {
+class RunLoop;
+}
+}
+
+namespace alk {
+
+/**
+ * Fetches vector tiles, glyphs and sprites through the renderers' file
+ * source, so they come out of the same vector cache the renderers fill.
+ *
+ * FileSource requests must be made and answered on a RunLoop, which the
+ * HTTP IO threads don't have, so the source runs one of its own. Responses
+ * hold the bytes as they were stored; they are never copied.
+ */
+class AssetSource : private mbgl::util::noncopyable {
+public:
+	// Receives the response on the source's thread.
+	using Callback = std::function<void (mbgl::Response)>;
+
+	struct Options {
+		// Tile url templates of the vector sources, by the name they are served under.
+		std::map<std::string, std::string> vectorSources;
+		// Url template of the glyphs, with {fontstack} and {range}.
+		std::string glyphs;
+		// Base urls of the sprites, by style name.
+		std::map<std::string, std::string> sprites;
+	};
+
+	AssetSource(mbgl::FileSource&, Options);
+	// Cancels the requests still in flight.
+	~AssetSource();
+
+	// The resource to fetch for the route, if there is one.
+	mbgl::optional<mbgl::Resource> resource(const TileRouter::Match&) const;
+
+	// Thread safe. The callback is called exactly once, unless the source is
+	// destroyed first.
+	void fetch(mbgl::Resource, Callback);
+
+private:
+	mbgl::FileSource& fileSource;
+	const Options options;
+	mbgl::util::RunLoop* loop = nullptr;
+	// Only used on the loop.
+	uint64_t nextRequest = 0;
+	std::unordered_map<uint64_t, std::unique_ptr<mbgl::AsyncRequest>> requests;
+	std::thread thread;
+};
+
+}
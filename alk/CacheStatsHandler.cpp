@@ -0,0 +1,56 @@
+/*
+ */
+#include "CacheStatsHandler.hpp"
+
+#include <proxygen/httpserver/RequestHandler.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace proxygen;
+
+namespace alk {
+
+CacheStatsHandler::CacheStatsHandler(TileMemoryCache::Stats stats_) :
+				stats(stats_) {
+}
+
+void CacheStatsHandler::onRequest(std::unique_ptr<HTTPMessage> /*headers*/) noexcept {
+}
+
+void CacheStatsHandler::onBody(std::unique_ptr<folly::IOBuf> /*body*/) noexcept {
+}
+
+void CacheStatsHandler::onEOM() noexcept {
+  const uint64_t lookups = stats.hits + stats.misses;
+  std::ostringstream s;
+  s << "{\"memoryCache\":{"
+    << "\"budget\":" << stats.budget << ","
+    << "\"bytes\":" << stats.bytes << ","
+    << "\"entries\":" << stats.entries << ","
+    << "\"hits\":" << stats.hits << ","
+    << "\"misses\":" << stats.misses << ","
+    << "\"evictions\":" << stats.evictions << ","
+    << "\"hitRatio\":" << (lookups ? double(stats.hits) / lookups : 0.0)
+    << "}}";
+  ResponseBuilder(downstream_)
+	  .status(200, "OK")
+	  .header("Content-Type", "application/json")
+	  .body(s.str())
+	  .sendWithEOM();
+}
+
+void CacheStatsHandler::onUpgrade(UpgradeProtocol /*protocol*/) noexcept {
+  // handler doesn't support upgrades
+}
+
+void CacheStatsHandler::requestComplete() noexcept {
+  delete this;
+}
+
+void CacheStatsHandler::onError(ProxygenError /*err*/) noexcept {
+  delete this;
+}
+
+}
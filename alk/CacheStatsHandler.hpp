@@ -0,0 +1,41 @@
+/*
+ */
+#pragma once
+
+#include <folly/Memory.h>
+#include <proxygen/httpserver/RequestHandler.h>
+#include <memory>
+
+#include "TileMemoryCache.hpp"
+
+namespace proxygen {
+class ResponseHandler;
+}
+
+namespace alk {
+
+/**
+ * Responds to /stats/cache with the in-memory tile cache statistics as JSON.
+ */
+class CacheStatsHandler : public proxygen::RequestHandler {
+ public:
+  explicit CacheStatsHandler(TileMemoryCache::Stats stats_);
+
+  void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers)
+      noexcept override;
+
+  void onBody(std::unique_ptr<folly::IOBuf> body) noexcept override;
+
+  void onEOM() noexcept override;
+
+  void onUpgrade(proxygen::UpgradeProtocol proto) noexcept override;
+
+  void requestComplete() noexcept override;
+
+  void onError(proxygen::ProxygenError err) noexcept override;
+
+ private:
+  TileMemoryCache::Stats stats;
+};
+
+}
@@ -0,0 +1,83 @@
+/*
+ */
+#include <mbgl/util/platform.hpp>
+#include <mbgl/util/string.hpp>
+
+#include <algorithm>
+
+#include "EncodePool.hpp"
+
+namespace alk {
+
+EncodePool::EncodePool(std::size_t workers_, std::size_t queueDepth_, TileEncoder::Options options_)
+	: queueDepth(queueDepth_),
+	  options(options_) {
+	stats.workers = workers_;
+	stats.queueDepth = queueDepth_;
+	threads.reserve(workers_);
+	for (std::size_t i = 0; i < workers_; ++i) {
+		threads.emplace_back([this, i] () { run(i); });
+	}
+}
+
+EncodePool::~EncodePool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		terminating = true;
+	}
+	ready.notify_all();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+bool EncodePool::submit(Task task) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (threads.empty() || queue.size() >= queueDepth) {
+			stats.refused++;
+			return false;
+		}
+		queue.push_back({ std::move(task), std::chrono::steady_clock::now() });
+	}
+	ready.notify_one();
+	return true;
+}
+
+void EncodePool::run(std::size_t index) {
+	mbgl::platform::setCurrentThreadName(std::string{ "Encode " } + mbgl::util::toString(index + 1));
+	TileEncoder encoder(options);
+
+	while (true) {
+		std::unique_lock<std::mutex> lock(mutex);
+		ready.wait(lock, [this] () { return !queue.empty() || terminating; });
+		if (queue.empty()) {
+			return;
+		}
+		Entry entry = std::move(queue.front());
+		queue.pop_front();
+		lock.unlock();
+
+		const auto begin = std::chrono::steady_clock::now();
+		entry.task(encoder);
+		const auto end = std::chrono::steady_clock::now();
+
+		lock.lock();
+		const std::chrono::duration<double, std::milli> wait = begin - entry.enqueued;
+		const std::chrono::duration<double, std::milli> encode = end - begin;
+		stats.tasks++;
+		stats.totalWait += wait;
+		stats.maximumWait = std::max(stats.maximumWait, wait);
+		stats.totalEncode += encode;
+		stats.maximumEncode = std::max(stats.maximumEncode, encode);
+	}
+}
+
+EncodePool::Stats EncodePool::getStats() {
+	std::lock_guard<std::mutex> lock(mutex);
+	Stats result = stats;
+	result.queued = queue.size();
+	return result;
+}
+
+}
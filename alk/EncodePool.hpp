@@ -0,0 +1,72 @@
+/*
+ */
+#pragma once
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TileEncoder.hpp"
+
+namespace alk {
+
+/**
+ * A pool of CPU threads that encode rendered tiles, so render workers can
+ * start on the next tile while the last one is compressed.
+ *
+ * Every thread has its own TileEncoder. When the queue is full, submit()
+ * refuses the task and the render worker encodes the tile itself, which
+ * keeps the pipeline from growing without bound.
+ */
+class EncodePool : private mbgl::util::noncopyable {
+public:
+	using Task = std::function<void (TileEncoder&)>;
+
+	struct Stats {
+		std::size_t workers = 0;
+		std::size_t queueDepth = 0;
+		std::size_t queued = 0;
+		uint64_t tasks = 0;
+		// Tasks refused because the queue was full.
+		uint64_t refused = 0;
+		std::chrono::duration<double, std::milli> totalWait { 0 };
+		std::chrono::duration<double, std::milli> maximumWait { 0 };
+		std::chrono::duration<double, std::milli> totalEncode { 0 };
+		std::chrono::duration<double, std::milli> maximumEncode { 0 };
+	};
+
+	EncodePool(std::size_t workers, std::size_t queueDepth, TileEncoder::Options options);
+	// Runs the queued tasks before returning.
+	~EncodePool();
+
+	// Thread safe. Returns false if the queue is full.
+	bool submit(Task task);
+
+	Stats getStats();
+
+private:
+	struct Entry {
+		Task task;
+		std::chrono::steady_clock::time_point enqueued;
+	};
+
+	void run(std::size_t index);
+
+	const std::size_t queueDepth;
+	const TileEncoder::Options options;
+	std::mutex mutex;
+	std::condition_variable ready;
+	std::deque<Entry> queue;
+	bool terminating = false;
+	Stats stats;
+	std::vector<std::thread> threads;
+};
+
+}
@@ -0,0 +1,74 @@
+/*
+ */
+#include <mbgl/util/chrono.hpp>
+
+#include <algorithm>
+#include <regex>
+#include <stdexcept>
+
+#include "ExpirationPolicy.hpp"
+
+namespace alk {
+
+constexpr uint8_t ExpirationPolicy::maxZoom;
+
+ExpirationPolicy::ExpirationPolicy(mbgl::Duration defaultTTL) {
+	ttls.fill(defaultTTL);
+}
+
+void ExpirationPolicy::setTTL(uint8_t minZoom, uint8_t maxZoom_, mbgl::Duration ttl) {
+	for (unsigned int z = minZoom; z <= maxZoom_ && z <= maxZoom; z++) {
+		ttls[z] = ttl;
+	}
+}
+
+void ExpirationPolicy::parseTTL(const std::string& spec) {
+	std::smatch m;
+	if (!std::regex_match(spec, m, std::regex("([0-9]+)(-([0-9]+))?=([0-9]+)"))) {
+		throw std::invalid_argument("TTL must be given as zoom=hours or minZoom-maxZoom=hours: " + spec);
+	}
+	const int minZoom = std::stoi(m[1]);
+	const int maxZoom_ = m[3].matched ? std::stoi(m[3]) : minZoom;
+	if (minZoom > maxZoom_ || maxZoom_ > maxZoom) {
+		throw std::invalid_argument("Invalid zoom range in TTL: " + spec);
+	}
+	setTTL(minZoom, maxZoom_, std::chrono::hours(std::stoi(m[4])));
+}
+
+mbgl::Duration ExpirationPolicy::getTTL(uint8_t zoom) const {
+	return ttls[std::min(zoom, maxZoom)];
+}
+
+void ExpirationPolicy::setStyleVersion(mbgl::optional<std::string> styleVersion_) {
+	styleVersion = std::move(styleVersion_);
+}
+
+const mbgl::optional<std::string>& ExpirationPolicy::getStyleVersion() const {
+	return styleVersion;
+}
+
+void ExpirationPolicy::setStaleWhileRevalidate(bool staleWhileRevalidate_) {
+	staleWhileRevalidate = staleWhileRevalidate_;
+}
+
+bool ExpirationPolicy::getStaleWhileRevalidate() const {
+	return staleWhileRevalidate;
+}
+
+void ExpirationPolicy::stamp(mbgl::Response& response, uint8_t zoom) const {
+	const mbgl::Timestamp now = mbgl::util::now();
+	response.modified = now;
+	response.expires = now + std::chrono::duration_cast<mbgl::Seconds>(getTTL(zoom));
+	// Expired tiles are only usable as stale data, see isStale.
+	response.mustRevalidate = true;
+	response.etag = styleVersion;
+}
+
+bool ExpirationPolicy::isStale(const mbgl::Response& response) const {
+	if (response.expires && *response.expires <= mbgl::util::now()) {
+		return true;
+	}
+	return styleVersion && response.etag != styleVersion;
+}
+
+}
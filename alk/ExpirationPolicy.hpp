@@ -0,0 +1,57 @@
+/*
+ */
+#pragma once
+
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/chrono.hpp>
+#include <mbgl/util/optional.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace alk {
+
+/**
+ * Decides how long rendered tiles stay fresh and what happens once they don't.
+ *
+ * Each zoom level has its own time to live. A tile is stale once it has
+ * expired, or when it was rendered for a different style version than the
+ * current one, so a style deploy ages tiles out instead of dropping them.
+ * With stale-while-revalidate, stale tiles are still served and re-rendered
+ * in the background; otherwise they are re-rendered on the request path.
+ */
+class ExpirationPolicy {
+public:
+	explicit ExpirationPolicy(mbgl::Duration defaultTTL = std::chrono::hours(30));
+
+	// Sets the time to live of tiles from minZoom to maxZoom inclusive.
+	void setTTL(uint8_t minZoom, uint8_t maxZoom, mbgl::Duration);
+
+	// Parses "zoom=hours" or "minZoom-maxZoom=hours" and applies it.
+	// Throws std::invalid_argument on a malformed spec.
+	void parseTTL(const std::string& spec);
+
+	mbgl::Duration getTTL(uint8_t zoom) const;
+
+	void setStyleVersion(mbgl::optional<std::string>);
+	const mbgl::optional<std::string>& getStyleVersion() const;
+
+	void setStaleWhileRevalidate(bool);
+	bool getStaleWhileRevalidate() const;
+
+	// Fills in the caching fields of a freshly rendered tile at zoom.
+	void stamp(mbgl::Response&, uint8_t zoom) const;
+
+	// True if the cached tile must not be served as fresh.
+	bool isStale(const mbgl::Response&) const;
+
+	static constexpr uint8_t maxZoom = 31;
+
+private:
+	std::array<mbgl::Duration, maxZoom + 1> ttls;
+	mbgl::optional<std::string> styleVersion;
+	bool staleWhileRevalidate = false;
+};
+
+}
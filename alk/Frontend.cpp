@@ -6,28 +6,26 @@
 #include <mbgl/map/transform_state.hpp>
 #include <mbgl/util/run_loop.hpp>
 #include <mbgl/storage/file_source.hpp>
-#include <iostream>
 #include "Frontend.hpp"
 
 namespace alk {
 
-Frontend::Frontend(mbgl::Size size_, float pixelRatio_, mbgl::FileSource& fileSource_, mbgl::Scheduler& scheduler_) :
-    mbgl::HeadlessFrontend(size_, pixelRatio_, fileSource_, scheduler_) {
+Frontend::Frontend(mbgl::Size size_, float pixelRatio_, mbgl::FileSource& fileSource_, mbgl::Scheduler& scheduler_,
+		const mbgl::optional<std::string>& programCacheDir_) :
+    mbgl::HeadlessFrontend(size_, pixelRatio_, fileSource_, scheduler_, programCacheDir_) {
 
 }
 
-Frontend::~Frontend() {
-	std::cout << "Frontend Gone!";
-}
-
-void Frontend::render(mbgl::Map& map, std::function<void (const mbgl::PremultipliedImage)> callback) {
+void Frontend::render(mbgl::Map& map, std::function<void (std::exception_ptr, mbgl::PremultipliedImage)> callback) {
 
     map.renderStill([this, callback](std::exception_ptr error) {
         if (error) {
-            std::rethrow_exception(error);
+            // We are on the renderer's RunLoop; throwing here would take the
+            // worker down with the request.
+            callback(error, mbgl::PremultipliedImage());
         } else {
         	mbgl::PremultipliedImage result = readStillImage();
-            callback(std::move(result));
+            callback(nullptr, std::move(result));
         }
     });
 }
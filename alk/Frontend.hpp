@@ -4,15 +4,20 @@
 #include <mbgl/map/map.hpp>
 #include <mbgl/map/transform_state.hpp>
 #include <mbgl/storage/file_source.hpp>
+#include <mbgl/util/optional.hpp>
 #include <mbgl/util/run_loop.hpp>
 
 namespace alk {
 
 class Frontend : public mbgl::HeadlessFrontend {
 public:
-	Frontend(mbgl::Size size_, float pixelRatio_, mbgl::FileSource& fileSource_, mbgl::Scheduler& scheduler_);
-	~Frontend();
-	void render(mbgl::Map& map, std::function<void (const mbgl::PremultipliedImage)> callback);
+	// Compiled shaders are kept in programCacheDir, if given, so later
+	// renderers and processes don't compile them again.
+	Frontend(mbgl::Size size_, float pixelRatio_, mbgl::FileSource& fileSource_, mbgl::Scheduler& scheduler_,
+			const mbgl::optional<std::string>& programCacheDir_ = {});
+	// Renders the map's current view. callback receives the image, or the
+	// error and an empty image if the render failed.
+	void render(mbgl::Map& map, std::function<void (std::exception_ptr, mbgl::PremultipliedImage)> callback);
 };
 
 }
@@ -0,0 +1,214 @@
+/*
+ */
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+#include "Metrics.hpp"
+
+namespace alk {
+
+constexpr std::size_t Metrics::stageCount;
+constexpr std::size_t Metrics::outcomeCount;
+constexpr std::size_t Metrics::counterCount;
+constexpr int Metrics::maxZoom;
+constexpr int Metrics::noZoom;
+constexpr std::size_t Metrics::subBuckets;
+constexpr std::size_t Metrics::bucketCount;
+constexpr std::size_t Metrics::zoomCount;
+constexpr std::size_t Metrics::seriesCount;
+constexpr std::size_t Metrics::shardCount;
+
+namespace {
+
+const char* const stageNames[] = {
+	"request", "queue_wait", "cache_lookup", "render", "encode", "write_back",
+};
+
+const char* const stageHelp[] = {
+	"Time from receiving a tile request to sending the response.",
+	"Time a tile job waited in the render queue.",
+	"Time to look a tile up in the raster cache.",
+	"Time to render a tile or metatile.",
+	"Time to slice and encode a rendered tile or metatile.",
+	"Time to write a batch of tiles to the raster cache.",
+};
+
+const char* const outcomeNames[] = {
+	"none", "memory", "hit", "stale", "miss", "error",
+};
+
+const char* const counterNames[] = {
+	"requests_rejected", "coalesced_requests", "inline_encodes", "cancelled_jobs",
+};
+
+const char* const counterHelp[] = {
+	"Tile requests refused because the render queue was full.",
+	"Tile requests answered by a render that was already in flight.",
+	"Tiles encoded by a render worker because the encode queue was full.",
+	"Render jobs dropped before rendering because their clients disconnected.",
+};
+
+const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+} // namespace
+
+Metrics& Metrics::get() {
+	static Metrics metrics;
+	return metrics;
+}
+
+const char* Metrics::outcomeName(Outcome outcome) {
+	return outcomeNames[std::size_t(outcome)];
+}
+
+Metrics::Metrics() = default;
+
+Metrics::~Metrics() {
+	for (auto& shard : shards) {
+		for (auto& slot : shard.series) {
+			delete slot.load();
+		}
+	}
+}
+
+std::size_t Metrics::bucketOf(uint64_t micros) {
+	micros = std::min<uint64_t>(micros, (uint64_t(1) << 32) - 1);
+	if (micros < 2 * subBuckets) {
+		return micros;
+	}
+	// The top bits of the value select the bucket within its power of two.
+	std::size_t magnitude = 0;
+	while ((micros >> magnitude) > 1) {
+		magnitude++;
+	}
+	const std::size_t shift = magnitude - 4;
+	return shift * subBuckets + (micros >> shift);
+}
+
+uint64_t Metrics::bucketUpperBound(std::size_t bucket) {
+	if (bucket < 2 * subBuckets) {
+		return bucket;
+	}
+	const std::size_t shift = bucket / subBuckets - 1;
+	const uint64_t sub = bucket % subBuckets + subBuckets;
+	return ((sub + 1) << shift) - 1;
+}
+
+std::size_t Metrics::seriesOf(Stage stage, int zoom, Outcome outcome) {
+	const std::size_t z = zoom < 0 ? zoomCount - 1 : std::min(zoom, maxZoom);
+	return (std::size_t(stage) * zoomCount + z) * outcomeCount + std::size_t(outcome);
+}
+
+Metrics::Shard& Metrics::currentShard() {
+	// Thread ids are often aligned addresses, so mix them before picking a shard.
+	const uint64_t id = std::hash<std::thread::id>()(std::this_thread::get_id());
+	return shards[(id * 0x9E3779B97F4A7C15ull) >> 60 & (shardCount - 1)];
+}
+
+void Metrics::record(Stage stage, int zoom, Outcome outcome, Duration duration) {
+	const auto micros = std::max<int64_t>(
+			std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 0);
+
+	auto& slot = currentShard().series[seriesOf(stage, zoom, outcome)];
+	Histogram* histogram = slot.load(std::memory_order_acquire);
+	if (!histogram) {
+		// Another thread striped onto this shard may race us to it.
+		auto fresh = new Histogram();
+		if (slot.compare_exchange_strong(histogram, fresh, std::memory_order_acq_rel)) {
+			histogram = fresh;
+		} else {
+			delete fresh;
+		}
+	}
+
+	histogram->buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+	histogram->count.fetch_add(1, std::memory_order_relaxed);
+	histogram->sum.fetch_add(micros, std::memory_order_relaxed);
+}
+
+void Metrics::increment(Counter counter, uint64_t n) {
+	currentShard().counters[std::size_t(counter)].fetch_add(n, std::memory_order_relaxed);
+}
+
+std::string Metrics::scrape() const {
+	std::ostringstream s;
+
+	for (std::size_t stage = 0; stage < stageCount; stage++) {
+		const std::string name = std::string("alk_") + stageNames[stage] + "_seconds";
+		s << "# HELP " << name << " " << stageHelp[stage] << "\n"
+		  << "# TYPE " << name << " summary\n";
+
+		for (std::size_t z = 0; z < zoomCount; z++) {
+			for (std::size_t outcome = 0; outcome < outcomeCount; outcome++) {
+				const std::size_t index = (stage * zoomCount + z) * outcomeCount + outcome;
+				std::array<uint64_t, bucketCount> buckets {};
+				uint64_t count = 0;
+				uint64_t sum = 0;
+				for (const auto& shard : shards) {
+					const Histogram* histogram = shard.series[index].load(std::memory_order_acquire);
+					if (!histogram) {
+						continue;
+					}
+					for (std::size_t b = 0; b < bucketCount; b++) {
+						buckets[b] += histogram->buckets[b].load(std::memory_order_relaxed);
+					}
+					count += histogram->count.load(std::memory_order_relaxed);
+					sum += histogram->sum.load(std::memory_order_relaxed);
+				}
+				if (count == 0) {
+					continue;
+				}
+
+				std::string labels;
+				if (z != zoomCount - 1) {
+					labels += "zoom=\"" + std::to_string(z) + "\"";
+				}
+				if (outcome != std::size_t(Outcome::None)) {
+					labels += std::string(labels.empty() ? "" : ",") + "outcome=\"" + outcomeNames[outcome] + "\"";
+				}
+				const std::string separator = labels.empty() ? "" : ",";
+				const std::string braced = labels.empty() ? "" : "{" + labels + "}";
+
+				// The buckets are summed without a lock, so count may be slightly
+				// ahead of them; the quantiles are taken from the buckets alone.
+				uint64_t total = 0;
+				for (auto n : buckets) {
+					total += n;
+				}
+				for (double q : quantiles) {
+					const uint64_t rank = std::max<uint64_t>(std::ceil(q * total), 1);
+					uint64_t seen = 0;
+					std::size_t b = 0;
+					for (; b < bucketCount - 1; b++) {
+						seen += buckets[b];
+						if (seen >= rank) {
+							break;
+						}
+					}
+					s << name << "{" << labels << separator << "quantile=\"" << q << "\"} "
+					  << bucketUpperBound(b) / 1e6 << "\n";
+				}
+				s << name << "_sum" << braced << " " << sum / 1e6 << "\n"
+				  << name << "_count" << braced << " " << count << "\n";
+			}
+		}
+	}
+
+	for (std::size_t counter = 0; counter < counterCount; counter++) {
+		uint64_t value = 0;
+		for (const auto& shard : shards) {
+			value += shard.counters[counter].load(std::memory_order_relaxed);
+		}
+		const std::string name = std::string("alk_") + counterNames[counter] + "_total";
+		s << "# HELP " << name << " " << counterHelp[counter] << "\n"
+		  << "# TYPE " << name << " counter\n"
+		  << name << " " << value << "\n";
+	}
+
+	return s.str();
+}
+
+}
@@ -0,0 +1,129 @@
+/*
+ */
+#pragma once
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace alk {
+
+/**
+ * Process-wide latency histograms and counters, exported on /metrics in the
+ * Prometheus text format.
+ *
+ * Recording is lock-free and cheap enough for every request: each thread
+ * writes to its own shard (threads are striped over the shards by id) with
+ * relaxed atomic increments, and shards are only summed when scraped.
+ *
+ * Latencies go into HDR-style log-linear histograms: 16 buckets per power of
+ * two of microseconds, which keeps the relative error of every reported
+ * quantile under 6.25% up to about an hour. Each series is allocated on its
+ * first sample, so only the combinations of stage, zoom and outcome that
+ * actually occur cost memory.
+ */
+class Metrics : private mbgl::util::noncopyable {
+public:
+	enum class Stage : uint8_t {
+		// From the request arriving to the response being sent.
+		Request,
+		// Time a job spent in the render queue.
+		QueueWait,
+		// Lookup in the raster cache.
+		CacheLookup,
+		Render,
+		// Slicing and encoding of a rendered (meta)tile.
+		Encode,
+		// Transaction writing a batch of tiles to the raster cache.
+		WriteBack,
+	};
+	static constexpr std::size_t stageCount = 6;
+
+	// How the tile was found. None leaves the series without an outcome label.
+	enum class Outcome : uint8_t {
+		None,
+		// Answered from the in-memory tile cache.
+		Memory,
+		// Fresh in the raster cache.
+		Hit,
+		// Served from the raster cache while it is re-rendered.
+		Stale,
+		// Not in the raster cache, or expired, and rendered.
+		Miss,
+		Error,
+	};
+	static constexpr std::size_t outcomeCount = 6;
+
+	enum class Counter : uint8_t {
+		// Requests refused with a 503 because the render queue was full.
+		Rejected,
+		// Requests answered by a render that was already in flight.
+		Coalesced,
+		// Tiles a render worker encoded itself because the encode queue was full.
+		InlineEncodes,
+		// Render jobs dropped because every request waiting on them went away.
+		Cancelled,
+	};
+	static constexpr std::size_t counterCount = 4;
+
+	// Zoom levels above maxZoom are recorded as maxZoom. Use noZoom for
+	// samples that don't belong to a single zoom level.
+	static constexpr int maxZoom = 24;
+	static constexpr int noZoom = -1;
+
+	using Duration = std::chrono::steady_clock::duration;
+
+	static Metrics& get();
+
+	static const char* outcomeName(Outcome);
+
+	// Thread safe and lock-free.
+	void record(Stage, int zoom, Outcome, Duration);
+	void record(Stage stage, int zoom, Duration duration) {
+		record(stage, zoom, Outcome::None, duration);
+	}
+	void increment(Counter, uint64_t n = 1);
+
+	// Thread safe. Renders all series in the Prometheus text format.
+	std::string scrape() const;
+
+	// Maps a duration in microseconds to its histogram bucket, and back to
+	// the largest duration in the bucket.
+	static std::size_t bucketOf(uint64_t micros);
+	static uint64_t bucketUpperBound(std::size_t bucket);
+
+	static constexpr std::size_t subBuckets = 16;
+	// Below 2 * subBuckets every microsecond has its own bucket; each power of
+	// two above it, up to 2^32, has subBuckets. Longer samples are clamped.
+	static constexpr std::size_t bucketCount = 2 * subBuckets + (32 - 5) * subBuckets;
+
+private:
+	Metrics();
+	~Metrics();
+
+	struct Histogram {
+		std::array<std::atomic<uint64_t>, bucketCount> buckets {};
+		std::atomic<uint64_t> count { 0 };
+		std::atomic<uint64_t> sum { 0 };
+	};
+
+	static constexpr std::size_t zoomCount = maxZoom + 2;
+	static constexpr std::size_t seriesCount = stageCount * zoomCount * outcomeCount;
+	static constexpr std::size_t shardCount = 16;
+
+	struct alignas(64) Shard {
+		std::array<std::atomic<Histogram*>, seriesCount> series {};
+		std::array<std::atomic<uint64_t>, counterCount> counters {};
+	};
+
+	static std::size_t seriesOf(Stage, int zoom, Outcome);
+	Shard& currentShard();
+
+	std::array<Shard, shardCount> shards;
+};
+
+}
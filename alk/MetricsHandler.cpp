@@ -0,0 +1,75 @@
+/*
+ */
+#include "MetricsHandler.hpp"
+#include "Metrics.hpp"
+
+#include <proxygen/httpserver/RequestHandler.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace proxygen;
+
+namespace alk {
+
+namespace {
+
+template <typename T>
+void metric(std::ostringstream& s, const char* name, const char* type, const char* help, T value) {
+  s << "# HELP " << name << " " << help << "\n"
+    << "# TYPE " << name << " " << type << "\n"
+    << name << " " << value << "\n";
+}
+
+} // namespace
+
+MetricsHandler::MetricsHandler(RenderPool::Stats renderPoolStats_,
+		EncodePool::Stats encodePoolStats_,
+		TileMemoryCache::Stats memoryCacheStats_) :
+				renderPoolStats(renderPoolStats_),
+				encodePoolStats(encodePoolStats_),
+				memoryCacheStats(memoryCacheStats_) {
+}
+
+void MetricsHandler::onRequest(std::unique_ptr<HTTPMessage> /*headers*/) noexcept {
+}
+
+void MetricsHandler::onBody(std::unique_ptr<folly::IOBuf> /*body*/) noexcept {
+}
+
+void MetricsHandler::onEOM() noexcept {
+  std::ostringstream s;
+  s << Metrics::get().scrape();
+  metric(s, "alk_render_queue_length", "gauge", "Tile jobs waiting for a render worker.", renderPoolStats.queued);
+  metric(s, "alk_render_background_queue_length", "gauge", "Stale tiles waiting to be re-rendered.", renderPoolStats.background);
+  metric(s, "alk_render_queue_capacity", "gauge", "Tile jobs that can wait before requests are refused.", renderPoolStats.queueDepth);
+  metric(s, "alk_render_workers", "gauge", "Render workers.", renderPoolStats.workers);
+  metric(s, "alk_encode_queue_length", "gauge", "Rendered tiles waiting to be encoded.", encodePoolStats.queued);
+  metric(s, "alk_encode_queue_capacity", "gauge", "Rendered tiles that can wait to be encoded.", encodePoolStats.queueDepth);
+  metric(s, "alk_encode_workers", "gauge", "Encode threads.", encodePoolStats.workers);
+  metric(s, "alk_memory_cache_bytes", "gauge", "Bytes of tiles in the memory cache.", memoryCacheStats.bytes);
+  metric(s, "alk_memory_cache_entries", "gauge", "Tiles in the memory cache.", memoryCacheStats.entries);
+  metric(s, "alk_memory_cache_hits_total", "counter", "Memory cache lookups that found the tile.", memoryCacheStats.hits);
+  metric(s, "alk_memory_cache_misses_total", "counter", "Memory cache lookups that missed.", memoryCacheStats.misses);
+  metric(s, "alk_memory_cache_evictions_total", "counter", "Tiles evicted from the memory cache.", memoryCacheStats.evictions);
+  ResponseBuilder(downstream_)
+	  .status(200, "OK")
+	  .header("Content-Type", "text/plain; version=0.0.4")
+	  .body(s.str())
+	  .sendWithEOM();
+}
+
+void MetricsHandler::onUpgrade(UpgradeProtocol /*protocol*/) noexcept {
+  // handler doesn't support upgrades
+}
+
+void MetricsHandler::requestComplete() noexcept {
+  delete this;
+}
+
+void MetricsHandler::onError(ProxygenError /*err*/) noexcept {
+  delete this;
+}
+
+}
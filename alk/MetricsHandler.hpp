@@ -0,0 +1,49 @@
+/*
+ */
+#pragma once
+
+#include <folly/Memory.h>
+#include <proxygen/httpserver/RequestHandler.h>
+#include <memory>
+
+#include "EncodePool.hpp"
+#include "RenderPool.hpp"
+#include "TileMemoryCache.hpp"
+
+namespace proxygen {
+class ResponseHandler;
+}
+
+namespace alk {
+
+/**
+ * Responds to /metrics with the latency histograms and counters of Metrics,
+ * and the current state of the queues and the memory cache, in the
+ * Prometheus text format.
+ */
+class MetricsHandler : public proxygen::RequestHandler {
+ public:
+  MetricsHandler(RenderPool::Stats renderPoolStats_,
+                 EncodePool::Stats encodePoolStats_,
+                 TileMemoryCache::Stats memoryCacheStats_);
+
+  void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers)
+      noexcept override;
+
+  void onBody(std::unique_ptr<folly::IOBuf> body) noexcept override;
+
+  void onEOM() noexcept override;
+
+  void onUpgrade(proxygen::UpgradeProtocol proto) noexcept override;
+
+  void requestComplete() noexcept override;
+
+  void onError(proxygen::ProxygenError err) noexcept override;
+
+ private:
+  RenderPool::Stats renderPoolStats;
+  EncodePool::Stats encodePoolStats;
+  TileMemoryCache::Stats memoryCacheStats;
+};
+
+}
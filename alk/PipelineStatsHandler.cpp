@@ -0,0 +1,91 @@
+/*
+ */
+#include "PipelineStatsHandler.hpp"
+
+#include <proxygen/httpserver/RequestHandler.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace proxygen;
+
+namespace alk {
+
+PipelineStatsHandler::PipelineStatsHandler(RenderPool::Stats renderPoolStats_,
+		std::vector<RenderStats> renderStats_,
+		EncodePool::Stats encodePoolStats_) :
+				renderPoolStats(renderPoolStats_),
+				renderStats(std::move(renderStats_)),
+				encodePoolStats(encodePoolStats_) {
+}
+
+void PipelineStatsHandler::onRequest(std::unique_ptr<HTTPMessage> /*headers*/) noexcept {
+}
+
+void PipelineStatsHandler::onBody(std::unique_ptr<folly::IOBuf> /*body*/) noexcept {
+}
+
+void PipelineStatsHandler::onEOM() noexcept {
+  // Renders and the encodes of their tiles, on the encode stage or by the
+  // worker itself when the stage was saturated, are summed over the workers.
+  unsigned long long renders = 0;
+  std::chrono::duration<double, std::milli> totalRender { 0 };
+  std::chrono::duration<double, std::milli> maximumRender { 0 };
+  std::chrono::duration<double, std::milli> totalEncode { 0 };
+  for (const auto& stats : renderStats) {
+    renders += stats.numberOfRequests;
+    totalRender += stats.renderingCurrentTotalDuration;
+    maximumRender = std::max(maximumRender, stats.maximumRenderDuration);
+    totalEncode += stats.encodingCurrentTotalDuration;
+  }
+
+  const auto& render = renderPoolStats;
+  const auto& encode = encodePoolStats;
+  std::ostringstream s;
+  s << "{\"render\":{"
+    << "\"workers\":" << render.workers << ","
+    << "\"warming\":" << render.warming << ","
+    << "\"queueDepth\":" << render.queueDepth << ","
+    << "\"queued\":" << render.queued << ","
+    << "\"background\":" << render.background << ","
+    << "\"jobs\":" << render.jobs << ","
+    << "\"cancelled\":" << render.cancelled << ","
+    << "\"averageWait\":" << (render.jobs ? render.totalWait.count() / render.jobs : 0.0) << ","
+    << "\"maximumWait\":" << render.maximumWait.count() << ","
+    << "\"renders\":" << renders << ","
+    << "\"averageRender\":" << (renders ? totalRender.count() / renders : 0.0) << ","
+    << "\"maximumRender\":" << maximumRender.count() << ","
+    << "\"averageEncode\":" << (renders ? totalEncode.count() / renders : 0.0)
+    << "},\"encode\":{"
+    << "\"workers\":" << encode.workers << ","
+    << "\"queueDepth\":" << encode.queueDepth << ","
+    << "\"queued\":" << encode.queued << ","
+    << "\"tasks\":" << encode.tasks << ","
+    << "\"refused\":" << encode.refused << ","
+    << "\"averageWait\":" << (encode.tasks ? encode.totalWait.count() / encode.tasks : 0.0) << ","
+    << "\"maximumWait\":" << encode.maximumWait.count() << ","
+    << "\"averageEncode\":" << (encode.tasks ? encode.totalEncode.count() / encode.tasks : 0.0) << ","
+    << "\"maximumEncode\":" << encode.maximumEncode.count()
+    << "}}";
+  ResponseBuilder(downstream_)
+	  .status(200, "OK")
+	  .header("Content-Type", "application/json")
+	  .body(s.str())
+	  .sendWithEOM();
+}
+
+void PipelineStatsHandler::onUpgrade(UpgradeProtocol /*protocol*/) noexcept {
+  // handler doesn't support upgrades
+}
+
+void PipelineStatsHandler::requestComplete() noexcept {
+  delete this;
+}
+
+void PipelineStatsHandler::onError(ProxygenError /*err*/) noexcept {
+  delete this;
+}
+
+}
@@ -0,0 +1,48 @@
+/*
+ */
+#pragma once
+
+#include <folly/Memory.h>
+#include <proxygen/httpserver/RequestHandler.h>
+#include <memory>
+#include <vector>
+
+#include "EncodePool.hpp"
+#include "RenderPool.hpp"
+
+namespace proxygen {
+class ResponseHandler;
+}
+
+namespace alk {
+
+/**
+ * Responds to /stats/pipeline with the queue depths and latencies of the
+ * render and encode stages as JSON.
+ */
+class PipelineStatsHandler : public proxygen::RequestHandler {
+ public:
+  PipelineStatsHandler(RenderPool::Stats renderPoolStats_,
+                       std::vector<RenderStats> renderStats_,
+                       EncodePool::Stats encodePoolStats_);
+
+  void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers)
+      noexcept override;
+
+  void onBody(std::unique_ptr<folly::IOBuf> body) noexcept override;
+
+  void onEOM() noexcept override;
+
+  void onUpgrade(proxygen::UpgradeProtocol proto) noexcept override;
+
+  void requestComplete() noexcept override;
+
+  void onError(proxygen::ProxygenError err) noexcept override;
+
+ private:
+  RenderPool::Stats renderPoolStats;
+  std::vector<RenderStats> renderStats;
+  EncodePool::Stats encodePoolStats;
+};
+
+}
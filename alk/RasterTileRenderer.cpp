@@ -9,6 +9,7 @@
 #include <mbgl/util/default_thread_pool.hpp>
 #include <mbgl/storage/file_source.hpp>
 #include <mbgl/style/style.hpp>
+#include <mbgl/util/logging.hpp>
 #include <mbgl/util/tileset.hpp>
 #include <mbgl/tile/tile_id.hpp>
 #include <mbgl/renderer/tile_parameters.hpp>
@@ -19,8 +20,12 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <algorithm>
 #include <cfloat>
+#include <sstream>
 
+#include "AccessLog.hpp"
+#include "Metrics.hpp"
 #include "RenderCache.hpp"
 #include "RasterTileRenderer.hpp"
 
@@ -49,15 +54,23 @@ namespace alk {
  * @param {double}       pitch_       The camera pitch.
  * @param {RenderCache&} renderCache_ This is the file source for storing rendered
  *                                    raster tiles.
+ * @param {ExpirationPolicy&} expirationPolicy_ This decides how long rendered tiles
+ *                                              stay fresh in the render cache.
  * @param {mbgl::FileSource&} fileSource_  This is the file source for caching
  *                                         things gotten from the network, such as
  *                                         vector tiles, styles, sprites, etc.
- * @param {std::mutex&} renderMutex_ This is the mutex with which to protect the
- *                                   rendering around the GL library, which seems
- *                                   to not be thread safe. It has thread safe
- *                                   render threads, We use this mutex around rendering,
- *                                   allowing different threads for multiple HTTP requests.
  * @param {ThreadPool} renderThreads This is a thread pool that the GL renderer may use.
+ * @param {unsigned int} metatile_    The metatile size, a power of 2. When greater than 1,
+ *                                    each render covers the aligned metatile x metatile block
+ *                                    around the requested tile, and the neighbouring tiles
+ *                                    are stored in the render cache in one batch.
+ * @param {TileEncoder::Options} encoderOptions_ The PNG, JPEG and WebP settings. Tiles
+ *                                              are encoded in the format of their path.
+ * @param {EncodePool*} encodePool_ The pool that encodes rendered tiles off this renderer's
+ *                                  thread. Without one, tiles are encoded right after rendering.
+ * @param {StyleSnapshot*} styleSnapshot_ Where renderers share the JSON of their style. If it
+ *                                        has the style, it isn't fetched again.
+ * @param {string} programCacheDir_ The directory compiled shaders are kept in, if any.
  *
  * For normal applications, use 256,256,1.
  */
@@ -70,9 +83,14 @@ RasterTileRenderer::RasterTileRenderer(
 		double bearing_,
 		double pitch_,
 		RenderCache& renderCache_,
+		const ExpirationPolicy& expirationPolicy_,
         mbgl::FileSource& fileSource_,
-		std::mutex& renderMutex_,
-		int renderThreads_)
+		int renderThreads_,
+		unsigned int metatile_,
+		TileEncoder::Options encoderOptions_,
+		EncodePool* encodePool_,
+		StyleSnapshot* styleSnapshot_,
+		const mbgl::optional<std::string>& programCacheDir_)
 	: id(id_),
 	  styleUrl(styleUrl_),
 	  width(width_),
@@ -80,12 +98,16 @@ RasterTileRenderer::RasterTileRenderer(
 	  pixelRatio(pixelRatio_),
 	  bearing(bearing_),
 	  pitch(pitch_),
+	  metatile(metatile_),
 	  renderCache(renderCache_),
+	  expirationPolicy(expirationPolicy_),
+	  encoder(encoderOptions_),
+	  encodePool(encodePool_),
+	  styleSnapshot(styleSnapshot_),
 	  fileSource(fileSource_),
-	  renderMutex(renderMutex_),
 	  threadPool(renderThreads_),
 	  frontend({ width_, height_ }, pixelRatio_,
-	    		 fileSource, this->threadPool),
+	    		 fileSource, this->threadPool, programCacheDir_),
 	  map(this->frontend,
 			        mbgl::MapObserver::nullObserver(),
 					// Height and width doesn't matter much here for rendering as
@@ -106,7 +128,13 @@ RasterTileRenderer::RasterTileRenderer(
     if (styleUrl.find("://") == std::string::npos) {
     	styleUrl = std::string("file://") + styleUrl;
     }
-    map.getStyle().loadURL(styleUrl);
+    auto json = styleSnapshot ? styleSnapshot->get(styleUrl) : nullptr;
+    if (json) {
+    	map.getStyle().loadJSON(*json);
+    	styleShared = true;
+    } else {
+    	map.getStyle().loadURL(styleUrl);
+    }
     map.setBearing(bearing);
     map.setPitch(pitch);
     //map.setDebug(mbgl::MapDebugOptions::TileBorders |
@@ -115,6 +143,8 @@ RasterTileRenderer::RasterTileRenderer(
 	std::chrono::system_clock::time_point begin =
 			std::chrono::system_clock::now();
     renderStats.renderStartTime = begin;
+    renderStats.numberOfRequests = 0;
+    renderStats.numberOfCoalescedRequests = 0;
     renderStats.minimumRenderDuration = std::chrono::duration<double, std::milli>::max();
     renderStats.maximumRenderDuration = std::chrono::duration<double, std::milli>::min();
 };
@@ -131,14 +161,23 @@ double RasterTileRenderer::getPitch() {
 RenderCache& RasterTileRenderer::getRenderCache() {
 	return renderCache;
 }
+const ExpirationPolicy& RasterTileRenderer::getExpirationPolicy() {
+	return expirationPolicy;
+}
 mbgl::FileSource& RasterTileRenderer::getFileSource() {
 	return fileSource;
 }
 
-RenderStats& RasterTileRenderer::getRenderStats() {
+RenderStats RasterTileRenderer::getRenderStats() {
+	std::lock_guard<std::mutex> lock(statsMutex);
 	return renderStats;
 }
 
+void RasterTileRenderer::addCoalescedRequests(unsigned long long n) {
+	std::lock_guard<std::mutex> lock(statsMutex);
+	renderStats.numberOfCoalescedRequests += n;
+}
+
 // http://wiki.openstreetmap.org/wiki/Slippy_map_tilenames
 static void tile2lonlat(double x, double y, int zoom, double *lon, double *lat) {
 	unsigned long long n = 1LL << zoom;
@@ -146,14 +185,34 @@ static void tile2lonlat(double x, double y, int zoom, double *lon, double *lat)
 	*lat = atan(sinh(M_PI * (1 - 2.0 * y / n))) * 180.0 / M_PI;
 }
 
-void RasterTileRenderer::renderTile(TilePath *path, std::function<void (const std::string data)> callback) {
+void RasterTileRenderer::renderTile(TilePath *path, std::function<void ()> rendered,
+		std::function<void (std::shared_ptr<const std::string> data, Neighbours neighbours)> callback) {
 	std::chrono::system_clock::time_point begin =
 			std::chrono::system_clock::now();
+
+	// In metatile mode we render the whole aligned block of n x n tiles that
+	// contains the requested tile. At low zooms the block can't be larger
+	// than the world.
+	const uint32_t n = std::min<unsigned long long>(metatile, 1ULL << path->zoom);
+	const unsigned long long x0 = path->x - path->x % n;
+	const unsigned long long y0 = path->y - path->y % n;
+
 	double lat = 0, lon = 0;
 	// The x,y integers in this calculation gets us the NW corner, but we need to set the center.
-	// The center is 0.5+x, 0.5+y.
-	tile2lonlat(path->x + 0.5, path->y + 0.5, path->zoom, &lon, &lat);
-	std::cout << "Rendering.... " << path->to_s() << " at " << lon << ", " << lat << std::endl;
+	// The center is x0 + n/2, y0 + n/2, which is 0.5+x, 0.5+y for a single tile.
+	tile2lonlat(x0 + n / 2.0, y0 + n / 2.0, path->zoom, &lon, &lat);
+	auto& accessLog = AccessLog::get();
+	if (accessLog.tracing()) {
+		std::ostringstream line;
+		line << "Rendering " << path->to_s() << " (" << n << "x" << n << ")"
+				<< " at " << lon << ", " << lat;
+		accessLog.trace(mbgl::Event::Render, line.str());
+	}
+
+	if (frontend.getSize() != mbgl::Size{ width * n, height * n }) {
+		frontend.setSize({ width * n, height * n });
+		map.setSize({ width * n, height * n });
+	}
 
 	// Vector tiles (z,x,y) render in a 512 space, but we want double the feature characteristics.
 	// So we back off the zoom 1, which may render 4-8 more vector tiles.
@@ -162,40 +221,164 @@ void RasterTileRenderer::renderTile(TilePath *path, std::function<void (const st
 	} else {
 		map.setLatLngZoom( { lat, lon }, path->zoom);
 	}
-	// The GL library is not thread safe beyond its own render threads.
-	// We lock against all other RasterTileRenders here.
-	renderMutex.lock();
-	frontend.render(map, [=] (mbgl::PremultipliedImage result) {
-		// We are done with GL Rendering.
-		renderMutex.unlock();
+	// Each renderer owns an independent headless GL context that is only
+	// ever driven from this renderer's thread, so renders need no global lock.
+	frontend.render(map, [=] (std::exception_ptr error, mbgl::PremultipliedImage result) {
+		if (error) {
+			try {
+				std::rethrow_exception(error);
+			} catch (const std::exception& e) {
+				mbgl::Log::Warning(mbgl::Event::Render, id + " failed to render " + path->to_s() + ": " + e.what());
+			} catch (...) {
+				mbgl::Log::Warning(mbgl::Event::Render, id + " failed to render " + path->to_s());
+			}
+			callback(nullptr, {});
+			rendered();
+			return;
+		}
 		std::chrono::system_clock::time_point end =
 				std::chrono::system_clock::now();
 		std::chrono::duration<double, std::milli> duration = end - begin;
-		renderStats.numberOfRequests++;
-		if (duration < renderStats.minimumRenderDuration) {
-			renderStats.minimumRenderDuration = duration;
-			renderStats.minimumRenderTilePath = *path;
+		Metrics::get().record(Metrics::Stage::Render, path->zoom,
+				std::chrono::duration_cast<Metrics::Duration>(duration));
+		shareStyle();
+		{
+			std::lock_guard<std::mutex> lock(statsMutex);
+			renderStats.numberOfRequests++;
+			if (duration < renderStats.minimumRenderDuration) {
+				renderStats.minimumRenderDuration = duration;
+				renderStats.minimumRenderTilePath = *path;
+			}
+			if (duration > renderStats.maximumRenderDuration) {
+				renderStats.maximumRenderDuration = duration;
+				renderStats.maximumRenderTilePath = *path;
+			}
+			renderStats.renderingCurrentTotalDuration += duration;
 		}
-		if (duration > renderStats.maximumRenderDuration) {
-			renderStats.maximumRenderDuration = duration;
-			renderStats.maximumRenderTilePath = *path;
+		auto& renderLog = AccessLog::get();
+		if (renderLog.tracing()) {
+			renderLog.trace(mbgl::Event::Render, "Rendered " + path->to_s() + " in " +
+					std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()) + "ms");
 		}
-		renderStats.renderingCurrentTotalDuration += duration;
-		std::cout << "........Rendered "
-				<< path->to_s()
-				<< " in " << std::chrono::duration_cast<std::chrono::milliseconds>(end-begin).count() << "ms" << std::endl;
-		auto data = mbgl::encodePNG(std::move(result));
-		std::chrono::system_clock::time_point end2 =
-				std::chrono::system_clock::now();
 
-		std::chrono::duration<double, std::milli> encDuration = end2 - end;
-		renderStats.encodingCurrentTotalDuration += encDuration;
-		std::cout << "Encoded "
-				<< path->to_s()
-				<< " in " << std::chrono::duration_cast<std::chrono::milliseconds>(
-						end2 - end).count() << "ms" << std::endl;
-		callback(data);
+		// Hand the image to the encode stage, so this renderer can start on
+		// the next tile. Encode here if there's no stage or it's saturated.
+		auto image = std::make_shared<mbgl::PremultipliedImage>(std::move(result));
+		const TilePath tilePath = *path;
+		auto encode = [this, image, tilePath, n, x0, y0, callback] (TileEncoder& tileEncoder) {
+			const auto encodeBegin = std::chrono::steady_clock::now();
+			Neighbours neighbours;
+			std::string data;
+			// An exception must not escape to the encode thread or the
+			// renderer's loop; the job fails like a failed render instead.
+			try {
+				data = encodeTile(tileEncoder, *image, tilePath, n, x0, y0, neighbours);
+			} catch (const std::exception& e) {
+				mbgl::Log::Warning(mbgl::Event::Image, id + " failed to encode " + tilePath.to_s() + ": " + e.what());
+				callback(nullptr, {});
+				return;
+			} catch (...) {
+				mbgl::Log::Warning(mbgl::Event::Image, id + " failed to encode " + tilePath.to_s());
+				callback(nullptr, {});
+				return;
+			}
+			const auto encodeDuration = std::chrono::steady_clock::now() - encodeBegin;
+			Metrics::get().record(Metrics::Stage::Encode, tilePath.zoom, encodeDuration);
+			{
+				std::lock_guard<std::mutex> lock(statsMutex);
+				renderStats.encodingCurrentTotalDuration += encodeDuration;
+			}
+			auto& encodeLog = AccessLog::get();
+			if (encodeLog.tracing()) {
+				encodeLog.trace(mbgl::Event::Image, "Encoded " + tilePath.to_s() + " in " +
+						std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(encodeDuration).count()) + "ms");
+			}
+			callback(std::make_shared<const std::string>(std::move(data)), std::move(neighbours));
+		};
+		if (!encodePool || !encodePool->submit(encode)) {
+			if (encodePool) {
+				Metrics::get().increment(Metrics::Counter::InlineEncodes);
+			}
+			encode(encoder);
+		}
+		rendered();
 	});
 }
 
+void RasterTileRenderer::warmUp(std::function<void (bool)> done) {
+	const auto begin = std::chrono::steady_clock::now();
+	if (frontend.getSize() != mbgl::Size{ width, height }) {
+		frontend.setSize({ width, height });
+		map.setSize({ width, height });
+	}
+	map.setLatLngZoom({ 0, 0 }, 0);
+	map.renderStill([this, begin, done] (std::exception_ptr error) {
+		if (error) {
+			try {
+				std::rethrow_exception(error);
+			} catch (const std::exception& e) {
+				mbgl::Log::Warning(mbgl::Event::Render, id + " failed to warm up: " + e.what());
+			} catch (...) {
+				mbgl::Log::Warning(mbgl::Event::Render, id + " failed to warm up");
+			}
+			done(false);
+			return;
+		}
+		shareStyle();
+		const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - begin;
+		auto& renderLog = AccessLog::get();
+		if (renderLog.tracing()) {
+			renderLog.trace(mbgl::Event::Render, id + " warmed up in " +
+					std::to_string(static_cast<long>(duration.count())) + "ms");
+		}
+		done(true);
+	});
+}
+
+void RasterTileRenderer::shareStyle() {
+	if (styleSnapshot && !styleShared) {
+		styleSnapshot->put(styleUrl, map.getStyle().getJSON());
+		styleShared = true;
+	}
+}
+
+std::string RasterTileRenderer::encodeTile(TileEncoder& tileEncoder, const mbgl::PremultipliedImage& image,
+		const TilePath& path, uint32_t n, unsigned long long x0, unsigned long long y0, Neighbours& neighbours) {
+	if (n == 1) {
+		return tileEncoder.encode(image, path.format);
+	}
+
+	// Slice the metatile. The requested tile goes back to the caller,
+	// which stores it; the neighbours go straight into the cache, and back
+	// to the caller for the requests waiting on them.
+	std::string data;
+	const mbgl::Size tileSize { image.size.width / n, image.size.height / n };
+	std::vector<std::pair<mbgl::Resource, mbgl::Response>> batch;
+	batch.reserve(n * n - 1);
+	neighbours.reserve(n * n - 1);
+	for (uint32_t ty = 0; ty < n; ty++) {
+		for (uint32_t tx = 0; tx < n; tx++) {
+			mbgl::PremultipliedImage tile(tileSize);
+			mbgl::PremultipliedImage::copy(image, tile,
+					{ tx * tileSize.width, ty * tileSize.height }, { 0, 0 }, tileSize);
+			auto encoded = tileEncoder.encode(tile, path.format);
+			if (x0 + tx == path.x && y0 + ty == path.y) {
+				data = std::move(encoded);
+				continue;
+			}
+			TilePath neighbour = path;
+			neighbour.x = x0 + tx;
+			neighbour.y = y0 + ty;
+			mbgl::Response response;
+			expirationPolicy.stamp(response, neighbour.zoom);
+			response.noContent = false;
+			response.data = std::make_shared<const std::string>(std::move(encoded));
+			neighbours.emplace_back(neighbour, response.data);
+			batch.emplace_back(RenderCache::tileResource(neighbour, pixelRatio), std::move(response));
+		}
+	}
+	renderCache.put(std::move(batch));
+	return data;
+}
+
 }
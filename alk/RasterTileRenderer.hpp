@@ -10,9 +10,16 @@
 #include <iostream>
 #include <fstream>
 #include <math.h>
+#include <memory>
+#include <utility>
+#include <vector>
 
+#include "EncodePool.hpp"
+#include "ExpirationPolicy.hpp"
 #include "RenderCache.hpp"
 #include "Frontend.hpp"
+#include "StyleSnapshot.hpp"
+#include "TileEncoder.hpp"
 #include "TilePath.hpp"
 
 #pragma once
@@ -27,12 +34,19 @@ struct RenderStats {
 	TilePath              minimumRenderTilePath;
 	std::chrono::duration<double, std::milli> maximumRenderDuration;
 	TilePath              maximumRenderTilePath;
+	// Spent encoding this renderer's tiles, on an encode thread or inline.
 	std::chrono::duration<double, std::milli> encodingCurrentTotalDuration;
 	unsigned long long numberOfRequests;
+	// Requests for a tile already being rendered that were answered by this render.
+	unsigned long long numberOfCoalescedRequests;
 };
 
 class RasterTileRenderer {
 public:
+	// The other tiles of a metatile, with the encoded data stored for them
+	// in the render cache.
+	using Neighbours = std::vector<std::pair<TilePath, std::shared_ptr<const std::string>>>;
+
 	explicit RasterTileRenderer(
 			std::string id_,
 			std::string styleUrl_,
@@ -42,16 +56,34 @@ public:
 			double bearing_,
 			double pitch_,
 			RenderCache& renderCache_,
+			const ExpirationPolicy& expirationPolicy_,
 			mbgl::FileSource& fileSource_,
-			std::mutex& renderMutex_,
-			int renderThreads_);
-	void renderTile(TilePath *path, std::function<void (const std::string data)> callback);
+			int renderThreads_,
+			unsigned int metatile_ = 1,
+			TileEncoder::Options encoderOptions_ = {},
+			EncodePool* encodePool_ = nullptr,
+			StyleSnapshot* styleSnapshot_ = nullptr,
+			const mbgl::optional<std::string>& programCacheDir_ = {});
+	// Renders the tile. rendered is called on this renderer's thread once it
+	// is free to take another tile; callback receives the encoded tile and
+	// its neighbours in the metatile, on an encode thread if the renderer has
+	// an EncodePool. If the render fails, callback receives a null pointer on
+	// this renderer's thread.
+	void renderTile(TilePath *path, std::function<void ()> rendered,
+			std::function<void (std::shared_ptr<const std::string> data, Neighbours neighbours)> callback);
+	// Renders the whole world once without keeping the image, so the style,
+	// sprites, glyphs and shaders are loaded before the first request. done
+	// is called on this renderer's thread with whether the render succeeded.
+	void warmUp(std::function<void (bool)> done);
 	double getPixelRatio();
 	double getBearing();
 	double getPitch();
 	RenderCache& getRenderCache();
+	const ExpirationPolicy& getExpirationPolicy();
 	mbgl::FileSource& getFileSource();
-	RenderStats& getRenderStats();
+	// Thread safe. Returns a snapshot of the statistics.
+	RenderStats getRenderStats();
+	void addCoalescedRequests(unsigned long long n);
 
 protected:
 	std::string id;
@@ -61,14 +93,27 @@ protected:
     double pixelRatio;
     double bearing;
     double pitch;
+    const uint32_t metatile;
 
 private:
+    // Only uses members that are safe to use from an encode thread.
+    std::string encodeTile(TileEncoder&, const mbgl::PremultipliedImage&, const TilePath&,
+    		uint32_t n, unsigned long long x0, unsigned long long y0, Neighbours& neighbours);
+    // Stores the loaded style in the snapshot, once.
+    void shareStyle();
+
     RenderCache& renderCache;
+    const ExpirationPolicy& expirationPolicy;
+    TileEncoder encoder;
+    EncodePool* encodePool;
+    StyleSnapshot* styleSnapshot;
+    bool styleShared = false;
     mbgl::FileSource& fileSource;
-    std::mutex& renderMutex;
     mbgl::ThreadPool threadPool;
     Frontend frontend;
     mbgl::Map map;
+    // Updated on this renderer's thread and encode threads, read by /stats.
+    std::mutex statsMutex;
     RenderStats renderStats;
 };
 };
@@ -0,0 +1,51 @@
+/*
+ */
+#include "ReadinessHandler.hpp"
+
+#include <proxygen/httpserver/RequestHandler.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+#include <memory>
+
+using namespace proxygen;
+
+namespace alk {
+
+ReadinessHandler::ReadinessHandler(bool ready_) :
+				ready(ready_) {
+}
+
+void ReadinessHandler::onRequest(std::unique_ptr<HTTPMessage> /*headers*/) noexcept {
+}
+
+void ReadinessHandler::onBody(std::unique_ptr<folly::IOBuf> /*body*/) noexcept {
+}
+
+void ReadinessHandler::onEOM() noexcept {
+  if (ready) {
+	  ResponseBuilder(downstream_)
+		  .status(200, "OK")
+		  .header("Content-Type", "text/plain")
+		  .body("ready\n")
+		  .sendWithEOM();
+  } else {
+	  ResponseBuilder(downstream_)
+		  .status(503, "Service Unavailable: Warming Up")
+		  .header("Content-Type", "text/plain")
+		  .body("warming up\n")
+		  .sendWithEOM();
+  }
+}
+
+void ReadinessHandler::onUpgrade(UpgradeProtocol /*protocol*/) noexcept {
+  // handler doesn't support upgrades
+}
+
+void ReadinessHandler::requestComplete() noexcept {
+  delete this;
+}
+
+void ReadinessHandler::onError(ProxygenError /*err*/) noexcept {
+  delete this;
+}
+
+}
@@ -0,0 +1,41 @@
+/*
+ */
+#pragma once
+
+#include <folly/Memory.h>
+#include <proxygen/httpserver/RequestHandler.h>
+#include <memory>
+
+namespace proxygen {
+class ResponseHandler;
+}
+
+namespace alk {
+
+/**
+ * Responds to /ready with 200 once every style is loaded and the render
+ * workers have warmed up, and with 503 until then, for load balancers and
+ * orchestrators to probe.
+ */
+class ReadinessHandler : public proxygen::RequestHandler {
+ public:
+  explicit ReadinessHandler(bool ready_);
+
+  void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers)
+      noexcept override;
+
+  void onBody(std::unique_ptr<folly::IOBuf> body) noexcept override;
+
+  void onEOM() noexcept override;
+
+  void onUpgrade(proxygen::UpgradeProtocol proto) noexcept override;
+
+  void requestComplete() noexcept override;
+
+  void onError(proxygen::ProxygenError err) noexcept override;
+
+ private:
+  bool ready;
+};
+
+}
@@ -8,6 +8,7 @@
 #include <mbgl/util/optional.hpp>
 #include <mbgl/storage/offline_database.hpp>
 
+#include <chrono>
 #include <vector>
 #include <mutex>
 #include <string>
@@ -15,9 +16,11 @@
 #include <mbgl/util/platform.hpp>
 #include <mbgl/util/url.hpp>
 #include <mbgl/util/thread.hpp>
+#include <mbgl/util/timer.hpp>
 #include <mbgl/util/work_request.hpp>
-#include <iostream>
 
+#include "AccessLog.hpp"
+#include "Metrics.hpp"
 #include "RenderCache.hpp"
 
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -26,24 +29,67 @@ namespace alk {
 
 class RenderCache::Impl {
 public:
-    Impl(mbgl::ActorRef<Impl> self, const std::string& cachePath, uint64_t maximumCacheSize) {
+    Impl(mbgl::ActorRef<Impl> self, const std::string& cachePath, uint64_t maximumCacheSize,
+         std::size_t batchSize_, mbgl::Duration flushInterval_, bool writeAheadLog)
+        : batchSize(batchSize_),
+          flushInterval(flushInterval_) {
         // Initialize the Database asynchronously so as to not block Actor creation.
-        self.invoke(&Impl::initializeOfflineDatabase, cachePath, maximumCacheSize);
+        self.invoke(&Impl::initializeOfflineDatabase, cachePath, maximumCacheSize, writeAheadLog);
     }
 
-    void initializeOfflineDatabase(std::string cachePath, uint64_t maximumCacheSize) {
+    ~Impl() {
+        if (offlineDatabase) {
+            flush();
+        }
+    }
+
+    void initializeOfflineDatabase(std::string cachePath, uint64_t maximumCacheSize, bool writeAheadLog) {
         offlineDatabase = std::make_unique<mbgl::OfflineDatabase>(cachePath, maximumCacheSize);
+        if (writeAheadLog) {
+            offlineDatabase->setWriteAheadLog(true);
+        }
     }
 
     void put(const mbgl::Resource& resource, const mbgl::Response& response) {
-        offlineDatabase->put(resource, response);
-        std::cout << "Put " << resource.url << std::endl;
+        pending.emplace_back(resource, response);
+        schedule();
+    }
+
+    void putAll(std::vector<std::pair<mbgl::Resource, mbgl::Response>> tiles) {
+        for (auto& tile : tiles) {
+            pending.push_back(std::move(tile));
+        }
+        schedule();
+    }
+
+    // Writes all pending puts in a single transaction.
+    void flush() {
+        flushTimer.stop();
+        if (pending.empty()) {
+            return;
+        }
+        const auto begin = std::chrono::steady_clock::now();
+        offlineDatabase->putBatch(pending);
+        Metrics::get().record(Metrics::Stage::WriteBack, Metrics::noZoom,
+                std::chrono::steady_clock::now() - begin);
+        auto& accessLog = AccessLog::get();
+        if (accessLog.tracing()) {
+            accessLog.trace(mbgl::Event::Database, "Put " + std::to_string(pending.size()) + " tiles");
+        }
+        pending.clear();
     }
 
     void request(mbgl::AsyncRequest* req, mbgl::Resource resource, mbgl::ActorRef<mbgl::FileSourceRequest> ref) {
         auto callback = [ref] (const mbgl::Response& res) mutable {
             ref.invoke(&mbgl::FileSourceRequest::setResponse, res);
         };
+        // Serve our own writes that haven't been flushed yet.
+        for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+            if (sameResource(it->first, resource)) {
+                callback(it->second);
+                return;
+            }
+        }
         auto offlineResponse = offlineDatabase->get(resource);
         if (!offlineResponse) {
 			// Ensure there's always a response that we can send, so the caller knows that
@@ -78,12 +124,40 @@ public:
     }
 
 private:
+    // Flushes right away once a batch is full, otherwise soon after the first put.
+    void schedule() {
+        if (pending.size() >= batchSize) {
+            flush();
+        } else if (pending.size() == 1) {
+            flushTimer.start(flushInterval, mbgl::Duration::zero(), [this] { flush(); });
+        }
+    }
+
+    static bool sameResource(const mbgl::Resource& a, const mbgl::Resource& b) {
+        if (a.kind == mbgl::Resource::Kind::Tile && b.kind == mbgl::Resource::Kind::Tile) {
+            return a.tileData && b.tileData &&
+                a.tileData->urlTemplate == b.tileData->urlTemplate &&
+                a.tileData->pixelRatio == b.tileData->pixelRatio &&
+                a.tileData->x == b.tileData->x &&
+                a.tileData->y == b.tileData->y &&
+                a.tileData->z == b.tileData->z;
+        }
+        return a.kind == b.kind && a.url == b.url;
+    }
+
     std::unordered_map<mbgl::AsyncRequest*, std::unique_ptr<mbgl::AsyncRequest>> tasks;
     std::unique_ptr<mbgl::OfflineDatabase> offlineDatabase;
+
+    const std::size_t batchSize;
+    const mbgl::Duration flushInterval;
+    std::vector<std::pair<mbgl::Resource, mbgl::Response>> pending;
+    mbgl::util::Timer flushTimer;
 };
 
-RenderCache::RenderCache(const std::string& cachePath, uint64_t maximumCacheSize) :
-		impl(std::make_unique<mbgl::util::Thread<Impl>>("RenderCache", cachePath, maximumCacheSize)) {
+RenderCache::RenderCache(const std::string& cachePath, uint64_t maximumCacheSize,
+		std::size_t batchSize, mbgl::Duration flushInterval, bool writeAheadLog) :
+		impl(std::make_unique<mbgl::util::Thread<Impl>>("RenderCache", cachePath, maximumCacheSize,
+				batchSize, flushInterval, writeAheadLog)) {
 }
 
 
@@ -111,4 +185,35 @@ void RenderCache::put(const mbgl::Resource& resource, const mbgl::Response& resp
     impl->actor().invoke(&Impl::put, resource, response);
 }
 
+void RenderCache::put(std::vector<std::pair<mbgl::Resource, mbgl::Response>> tiles) {
+    if (tiles.empty()) {
+        return;
+    }
+    impl->actor().invoke(&Impl::putAll, std::move(tiles));
+}
+
+mbgl::Resource RenderCache::tileResource(const TilePath& path, float pixelRatio) {
+    // The style, tile size, scale and format are part of the key, so each is
+    // cached separately. The pixel ratio isn't: the template has no {ratio}.
+    // 512px tiles at 1x leave the size and scale out, so caches from before
+    // they were configurable stay valid.
+    std::string urlTemplate = "/" + (path.name.empty() ? std::string("data") : path.name) + "/";
+    if (path.tileSize != 512) {
+        urlTemplate += std::to_string(path.tileSize) + "/";
+    }
+    urlTemplate += "{z}/{x}/{y}";
+    if (path.scale != 1) {
+        urlTemplate += "@" + std::to_string(path.scale) + "x";
+    }
+    urlTemplate += "." + (path.format.empty() ? std::string("png") : path.format);
+    return mbgl::Resource::tile(
+        urlTemplate,
+        pixelRatio,
+        path.x,
+        path.y,
+        path.zoom,
+        mbgl::Tileset::Scheme::XYZ,
+        mbgl::Resource::LoadingMethod::CacheOnly);
+}
+
 }
@@ -5,10 +5,14 @@
 #include <mbgl/storage/file_source.hpp>
 #include <mbgl/storage/offline.hpp>
 #include <mbgl/util/constants.hpp>
+#include <mbgl/util/chrono.hpp>
 #include <mbgl/util/optional.hpp>
 
 #include <vector>
 #include <mutex>
+#include <utility>
+
+#include "TilePath.hpp"
 
 namespace mbgl {
 
@@ -23,7 +27,16 @@ namespace alk {
 
 class RenderCache : public mbgl::FileSource {
 public:
-	RenderCache(const std::string& cachePath, uint64_t maximumCacheSize);
+	/*
+	 * Puts are written behind: they are queued on the cache thread and written
+	 * in a single transaction once batchSize tiles are pending, or flushInterval
+	 * after the first one. writeAheadLog switches the database to WAL journaling
+	 * with normal syncs, which is safe because it only holds cached tiles.
+	 */
+	RenderCache(const std::string& cachePath, uint64_t maximumCacheSize,
+			std::size_t batchSize = 1,
+			mbgl::Duration flushInterval = mbgl::Duration::zero(),
+			bool writeAheadLog = false);
     ~RenderCache() override;
 
     std::unique_ptr<mbgl::AsyncRequest> request(const mbgl::Resource&, Callback) override;
@@ -46,6 +59,16 @@ public:
 
     void put(const mbgl::Resource&, const mbgl::Response&);
 
+    /*
+     * Store several rendered tiles with a single message to the cache thread.
+     */
+    void put(std::vector<std::pair<mbgl::Resource, mbgl::Response>>);
+
+    /*
+     * The resource under which the rendered tile for the path is cached.
+     */
+    static mbgl::Resource tileResource(const TilePath&, float pixelRatio);
+
     class Impl;
 private:
     const std::unique_ptr<mbgl::util::Thread<Impl>> impl;
@@ -0,0 +1,548 @@
+/*
+ */
+#include <mbgl/util/platform.hpp>
+#include <mbgl/util/run_loop.hpp>
+#include <mbgl/util/string.hpp>
+
+#include <algorithm>
+#include <future>
+#include <iterator>
+#include <list>
+#include <thread>
+
+#include "Metrics.hpp"
+#include "RenderPool.hpp"
+#include "Tile.hpp"
+#include "TileLoader.hpp"
+
+namespace alk {
+
+class RenderPool::Worker {
+public:
+	Worker(RenderPool& pool_, const std::string& id_)
+		: pool(pool_), id(id_) {
+		std::promise<void> running;
+
+		thread = std::thread([&] () {
+			mbgl::platform::setCurrentThreadName(id);
+
+			mbgl::util::RunLoop loop_(mbgl::util::RunLoop::Type::New);
+			loop = &loop_;
+			running.set_value();
+
+			loop->run();
+			loop = nullptr;
+		});
+
+		running.get_future().get();
+	}
+
+	~Worker() {
+		std::promise<void> drained;
+		std::promise<void> joinable;
+
+		// Tiles handed to the encode stage still refer to their renderer, so
+		// wait for them before tearing the renderers down.
+		loop->invoke([&] () {
+			stopping = &drained;
+			if (loaders == 0) {
+				drained.set_value();
+			}
+		});
+
+		drained.get_future().get();
+
+		// The renderers must be torn down on the thread they were created on,
+		// and before the loop is stopped so their handles are released.
+		loop->invoke([&] () {
+			std::list<Slot> released;
+			{
+				std::lock_guard<std::mutex> lock(renderersMutex);
+				released.swap(renderers);
+			}
+			released.clear();
+			joinable.set_value();
+		});
+
+		joinable.get_future().get();
+
+		loop->stop();
+		thread.join();
+	}
+
+	// Thread safe. Asks the worker to look for work.
+	void wake() {
+		loop->invoke([this] () { next(); });
+	}
+
+	// Thread safe. Creates and warms up the renderers for the keys, then
+	// looks for work. The worker must not be idle.
+	void warmUp(std::vector<RendererKey> keys) {
+		loop->invoke([this, keys] () { warm(keys, 0); });
+	}
+
+	// Thread safe.
+	void getRenderStats(std::vector<RenderStats>& stats) {
+		std::lock_guard<std::mutex> lock(renderersMutex);
+		for (auto& slot : renderers) {
+			stats.push_back(slot.renderer->getRenderStats());
+		}
+	}
+
+private:
+	struct Slot {
+		RendererKey key;
+		std::unique_ptr<RasterTileRenderer> renderer;
+		// Loaders using the renderer; it can't be evicted while there are any.
+		std::size_t loaders = 0;
+	};
+
+	// Returns the renderer for the key, creating it if needed and evicting
+	// the least recently used idle renderers beyond the pool's limit.
+	Slot* acquire(const RendererKey& key) {
+		auto it = std::find_if(renderers.begin(), renderers.end(), [&] (const Slot& slot) {
+			return slot.key == key;
+		});
+		if (it != renderers.end()) {
+			std::lock_guard<std::mutex> lock(renderersMutex);
+			renderers.splice(renderers.begin(), renderers, it);
+			return &renderers.front();
+		}
+
+		auto renderer = pool.factory(id + " " + key.to_s(), key);
+		if (!renderer) {
+			return nullptr;
+		}
+
+		std::list<Slot> evicted;
+		{
+			std::lock_guard<std::mutex> lock(renderersMutex);
+			renderers.push_front({ key, std::move(renderer), 0 });
+			for (auto slot = std::prev(renderers.end());
+					renderers.size() > pool.renderersPerWorker && slot != renderers.begin();) {
+				auto victim = slot--;
+				if (victim->loaders == 0) {
+					evicted.splice(evicted.end(), renderers, victim);
+				}
+			}
+		}
+		// Renderers are destroyed outside the lock, which stats readers take.
+		evicted.clear();
+		return &renderers.front();
+	}
+
+	void warm(const std::vector<RendererKey>& keys, std::size_t index) {
+		if (stopping || index == keys.size()) {
+			pool.warmed();
+			next();
+			return;
+		}
+
+		Slot* slot = acquire(keys[index]);
+		if (!slot) {
+			warm(keys, index + 1);
+			return;
+		}
+		loaders++;
+		slot->loaders++;
+		slot->renderer->warmUp([this, keys, index, slot] (bool) {
+			loop->invoke([this, keys, index, slot] () {
+				slot->loaders--;
+				if (--loaders == 0 && stopping) {
+					stopping->set_value();
+				}
+				warm(keys, index + 1);
+			});
+		});
+	}
+
+	void next() {
+		if (stopping) {
+			return;
+		}
+
+		auto job = std::make_shared<RenderJob>();
+		if (!pool.take(this, *job)) {
+			return;
+		}
+
+		Slot* slot = acquire(RendererKey::of(job->path));
+		if (!slot) {
+			pool.finish(*job, nullptr, {}, Metrics::Outcome::Error);
+			loop->invoke([this] () { next(); });
+			return;
+		}
+
+		// The renderer is free as soon as the tile is rendered; the encoding
+		// may still be running on the encode stage when we take the next job.
+		loaders++;
+		slot->loaders++;
+		TileLoader* loader = new TileLoader(&job->path, slot->renderer.get(), [this] () {
+			loop->invoke([this] () { next(); });
+		});
+		// Runs on this thread, or on an encode thread.
+		auto done = [this, job, loader, slot] (Tile& tile) {
+			// Stale tiles are served, but must not be kept in memory.
+			mbgl::optional<mbgl::Timestamp> expires = tile.expires;
+			if (tile.stale) {
+				expires = mbgl::util::now();
+			}
+			const std::size_t coalesced = pool.finish(*job, tile.data, expires, tile.outcome, tile.neighbours);
+			Metrics::get().increment(Metrics::Counter::Coalesced, coalesced);
+			if (tile.stale) {
+				// We've answered with the stale tile; refresh it for next time.
+				RenderJob refresh;
+				refresh.path = job->path;
+				refresh.background = true;
+				pool.submit(std::move(refresh));
+			}
+			// We are still inside the loader's callback, so defer its
+			// destruction to the following loop iteration. The loader refers
+			// to the job's path, so the job must outlive it.
+			loop->invoke([this, job, loader, slot, coalesced] () {
+				slot->renderer->addCoalescedRequests(coalesced);
+				slot->loaders--;
+				delete loader;
+				if (--loaders == 0 && stopping) {
+					stopping->set_value();
+				}
+			});
+		};
+		if (job->background) {
+			loader->revalidate(done);
+		} else {
+			loader->load(done);
+		}
+	}
+
+	RenderPool& pool;
+	const std::string id;
+	mbgl::util::RunLoop* loop = nullptr;
+	// Most recently used first. Only changed on the loop; the lock is for
+	// readers on other threads.
+	std::mutex renderersMutex;
+	std::list<Slot> renderers;
+	std::thread thread;
+	// Loaders that haven't delivered their tile yet. Only used on the loop.
+	std::size_t loaders = 0;
+	// Set when the worker is being destroyed; fulfilled once loaders is zero.
+	std::promise<void>* stopping = nullptr;
+};
+
+constexpr std::chrono::milliseconds RenderPool::zoomDelay;
+
+RendererKey RendererKey::of(const TilePath& path) {
+	return { path.name, path.tileSize, path.scale };
+}
+
+double RendererKey::pixelRatio() const {
+	return (tileSize < 512 ? 1.0 : 2.0) * scale;
+}
+
+unsigned int RendererKey::fitMetatile(unsigned int metatile, unsigned int maxTextureSize) const {
+	unsigned int n = std::max(metatile, 1u);
+	while (n > 1 && tileSize * n * pixelRatio() > maxTextureSize) {
+		n /= 2;
+	}
+	return n;
+}
+
+bool RendererKey::operator==(const RendererKey& other) const {
+	return style == other.style && tileSize == other.tileSize && scale == other.scale;
+}
+
+std::string RendererKey::to_s() const {
+	return style + "/" + mbgl::util::toString(tileSize) + "@" + mbgl::util::toString(scale) + "x";
+}
+
+RenderPool::RenderPool(std::size_t workers_, std::size_t queueDepth_, std::size_t renderersPerWorker_,
+		RendererFactory factory_, unsigned int metatile_, unsigned int maxTextureSize_)
+	: queueDepth(queueDepth_),
+	  renderersPerWorker(std::max<std::size_t>(renderersPerWorker_, 1)),
+	  metatile(std::max(metatile_, 1u)),
+	  maxTextureSize(maxTextureSize_),
+	  factory(std::move(factory_)) {
+	workers.reserve(workers_);
+	for (std::size_t i = 0; i < workers_; ++i) {
+		workers.emplace_back(std::make_unique<Worker>(
+				*this, std::string{ "Render " } + mbgl::util::toString(i + 1)));
+		std::lock_guard<std::mutex> lock(mutex);
+		idle.push_back(workers.back().get());
+	}
+}
+
+RenderPool::~RenderPool() = default;
+
+std::string RenderPool::blockKey(const TilePath& path) const {
+	// As RasterTileRenderer aligns them; at low zooms the block can't be
+	// larger than the world.
+	const unsigned long long n = std::min<unsigned long long>(
+			RendererKey::of(path).fitMetatile(metatile, maxTextureSize), 1ULL << path.zoom);
+	TilePath block = path;
+	block.x -= block.x % n;
+	block.y -= block.y % n;
+	return block.to_s();
+}
+
+bool RenderPool::submit(RenderJob job) {
+	Worker* worker = nullptr;
+	std::vector<RenderCallback> dropped;
+	bool accepted = true;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		const auto key = blockKey(job.path);
+		auto it = inflight.find(key);
+		if (it != inflight.end()) {
+			if (job.background) {
+				// Whatever is in flight will refresh the cache anyway.
+				return true;
+			}
+			// A request is now waiting on the block; if it's only queued for
+			// a background refresh, promote it. Rendering the requested tile
+			// refreshes the rest of the block too.
+			auto queued = std::find_if(background.begin(), background.end(), [&] (const RenderJob& j) {
+				return blockKey(j.path) == key;
+			});
+			if (queued != background.end()) {
+				queued->path = job.path;
+				queued->background = false;
+				queued->callback = std::move(job.callback);
+				queued->obsolete = std::move(job.obsolete);
+				queued->submitted = std::chrono::steady_clock::now();
+				enqueue(std::move(*queued));
+				background.erase(queued);
+			} else {
+				it->second.push_back({ job.path, std::move(job.callback), std::move(job.obsolete) });
+			}
+			return true;
+		}
+		if (job.background) {
+			accepted = background.size() < queueDepth;
+		} else {
+			// Requests whose clients went away don't count against the depth.
+			if (queue.size() >= queueDepth) {
+				purge(dropped);
+			}
+			accepted = queue.size() < queueDepth;
+		}
+		if (accepted) {
+			inflight.emplace(key, std::vector<Waiter>());
+			job.submitted = std::chrono::steady_clock::now();
+			if (job.background) {
+				background.push_back(std::move(job));
+			} else {
+				enqueue(std::move(job));
+			}
+			worker = dispatch();
+		}
+	}
+
+	for (auto& callback : dropped) {
+		callback(nullptr, {}, Metrics::Outcome::None);
+	}
+	if (worker) {
+		worker->wake();
+	}
+	return accepted;
+}
+
+void RenderPool::enqueue(RenderJob job) {
+	const auto due = job.submitted + zoomDelay * job.path.zoom;
+	queue.emplace(due, std::move(job));
+}
+
+bool RenderPool::isObsolete(const RenderJob& job) {
+	if (!job.obsolete || !job.obsolete->load(std::memory_order_relaxed)) {
+		return false;
+	}
+	auto it = inflight.find(blockKey(job.path));
+	if (it != inflight.end()) {
+		for (const auto& waiter : it->second) {
+			if (!waiter.obsolete || !waiter.obsolete->load(std::memory_order_relaxed)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void RenderPool::cancel(RenderJob& job, std::vector<RenderCallback>& callbacks) {
+	auto it = inflight.find(blockKey(job.path));
+	if (it != inflight.end()) {
+		for (auto& waiter : it->second) {
+			callbacks.push_back(std::move(waiter.callback));
+		}
+		inflight.erase(it);
+	}
+	if (job.callback) {
+		callbacks.push_back(std::move(job.callback));
+	}
+	cancelled++;
+	Metrics::get().increment(Metrics::Counter::Cancelled);
+}
+
+void RenderPool::purge(std::vector<RenderCallback>& callbacks) {
+	for (auto it = queue.begin(); it != queue.end();) {
+		if (isObsolete(it->second)) {
+			cancel(it->second, callbacks);
+			it = queue.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+RenderPool::Worker* RenderPool::dispatch() {
+	if (idle.empty()) {
+		return nullptr;
+	}
+	Worker* worker = idle.back();
+	idle.pop_back();
+	return worker;
+}
+
+bool RenderPool::take(Worker* worker, RenderJob& job) {
+	std::vector<RenderCallback> dropped;
+	bool found = false;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		while (!queue.empty() && !found) {
+			auto first = queue.begin();
+			if (isObsolete(first->second)) {
+				cancel(first->second, dropped);
+			} else {
+				job = std::move(first->second);
+				found = true;
+			}
+			queue.erase(first);
+		}
+		if (!found && !background.empty()) {
+			job = std::move(background.front());
+			background.pop_front();
+			found = true;
+		}
+		if (found) {
+			const auto waited = std::chrono::steady_clock::now() - job.submitted;
+			Metrics::get().record(Metrics::Stage::QueueWait, job.path.zoom, waited);
+			const std::chrono::duration<double, std::milli> wait = waited;
+			jobs++;
+			totalWait += wait;
+			maximumWait = std::max(maximumWait, wait);
+		} else {
+			idle.push_back(worker);
+		}
+	}
+
+	// Obsolete requests are answered so they can clean up.
+	for (auto& callback : dropped) {
+		callback(nullptr, {}, Metrics::Outcome::None);
+	}
+	return found;
+}
+
+std::size_t RenderPool::finish(const RenderJob& job, std::shared_ptr<const std::string> data,
+		mbgl::optional<mbgl::Timestamp> expires, Metrics::Outcome outcome,
+		const RasterTileRenderer::Neighbours& neighbours) {
+	std::vector<Waiter> waiting;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = inflight.find(blockKey(job.path));
+		if (it != inflight.end()) {
+			waiting = std::move(it->second);
+			inflight.erase(it);
+		}
+	}
+
+	if (job.callback) {
+		job.callback(data, expires, outcome);
+	}
+
+	std::size_t answered = 0;
+	std::vector<RenderJob> resubmit;
+	for (auto& waiter : waiting) {
+		// A failed render fails the whole block.
+		if (!data || (waiter.path.x == job.path.x && waiter.path.y == job.path.y)) {
+			waiter.callback(data, expires, outcome);
+			answered++;
+			continue;
+		}
+		auto neighbour = std::find_if(neighbours.begin(), neighbours.end(), [&] (const auto& n) {
+			return n.first.x == waiter.path.x && n.first.y == waiter.path.y;
+		});
+		if (neighbour != neighbours.end()) {
+			waiter.callback(neighbour->second, expires, outcome);
+			answered++;
+			continue;
+		}
+		RenderJob retry;
+		retry.path = std::move(waiter.path);
+		retry.callback = std::move(waiter.callback);
+		retry.obsolete = std::move(waiter.obsolete);
+		resubmit.push_back(std::move(retry));
+	}
+
+	for (auto& retry : resubmit) {
+		RenderCallback callback = retry.callback;
+		if (!submit(std::move(retry))) {
+			callback(nullptr, {}, Metrics::Outcome::Error);
+		}
+	}
+	return answered;
+}
+
+void RenderPool::warmUp(std::vector<RendererKey> keys) {
+	if (keys.size() > renderersPerWorker) {
+		keys.resize(renderersPerWorker);
+	}
+	std::vector<Worker*> workersToWarm;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		workersToWarm.swap(idle);
+		warming += workersToWarm.size();
+	}
+	for (auto worker : workersToWarm) {
+		worker->warmUp(keys);
+	}
+}
+
+void RenderPool::warmed() {
+	warming--;
+}
+
+bool RenderPool::ready() const {
+	return warming == 0;
+}
+
+std::size_t RenderPool::queued() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return queue.size();
+}
+
+std::size_t RenderPool::getQueueDepth() const {
+	return queueDepth;
+}
+
+RenderPool::Stats RenderPool::getStats() {
+	std::lock_guard<std::mutex> lock(mutex);
+	Stats stats;
+	stats.workers = workers.size();
+	stats.queueDepth = queueDepth;
+	stats.queued = queue.size();
+	stats.background = background.size();
+	stats.jobs = jobs;
+	stats.cancelled = cancelled;
+	stats.warming = warming;
+	stats.totalWait = totalWait;
+	stats.maximumWait = maximumWait;
+	return stats;
+}
+
+std::vector<RenderStats> RenderPool::getRenderStats() {
+	std::vector<RenderStats> stats;
+	for (auto& worker : workers) {
+		worker->getRenderStats(stats);
+	}
+	return stats;
+}
+
+}
@@ -0,0 +1,214 @@
+/*
+ */
+#pragma once
+
+#include <mbgl/util/chrono.hpp>
+#include <mbgl/util/noncopyable.hpp>
+#include <mbgl/util/optional.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Metrics.hpp"
+#include "RasterTileRenderer.hpp"
+#include "TilePath.hpp"
+
+namespace alk {
+
+/**
+ * Receives the encoded tile, or a null pointer on failure, the time after
+ * which it must no longer be served from memory, and how it was found.
+ */
+using RenderCallback = std::function<void (std::shared_ptr<const std::string> data,
+		mbgl::optional<mbgl::Timestamp> expires, Metrics::Outcome outcome)>;
+
+/**
+ * A unit of work for the render pool. The callback is invoked on the
+ * worker thread, or on an encode thread when the renderer has an EncodePool.
+ */
+struct RenderJob {
+	TilePath path;
+	// Background jobs re-render a stale tile into the cache. They have no
+	// callback and only run when no requests are waiting.
+	bool background = false;
+	RenderCallback callback;
+	// Set by the requester once nobody wants the tile any more, like
+	// GeometryTileWorker::obsolete. Jobs that are only wanted by obsolete
+	// requests are dropped before they are rendered, and their callbacks get
+	// a null pointer.
+	std::shared_ptr<const std::atomic<bool>> obsolete;
+	// Set by the pool when the job is queued.
+	std::chrono::steady_clock::time_point submitted;
+};
+
+/**
+ * Identifies the renderers that can render a tile: its style, its logical
+ * size and its pixel density.
+ */
+struct RendererKey {
+	std::string style;
+	unsigned int tileSize = 512;
+	unsigned int scale = 1;
+
+	static RendererKey of(const TilePath&);
+
+	// The density tiles are rendered at. 512 pixel tiles have always been
+	// rendered at twice the density of 256 pixel ones, so that they show the
+	// same features at the same zoom.
+	double pixelRatio() const;
+	// The largest metatile, up to metatile, whose render fits a framebuffer
+	// of maxTextureSize pixels square. At least 1.
+	unsigned int fitMetatile(unsigned int metatile, unsigned int maxTextureSize) const;
+
+	bool operator==(const RendererKey&) const;
+	std::string to_s() const;
+};
+
+/**
+ * A fixed-size pool of render workers, decoupled from the HTTP IO threads.
+ *
+ * Each worker owns its own RunLoop thread and a few RasterTileRenderers (and
+ * thus their mbgl::Maps and headless backends), one per RendererKey it has
+ * recently served. Renderers are created on first use and the least recently
+ * used idle ones are dropped beyond renderersPerWorker. Workers pull jobs from a single
+ * bounded queue shared by all IO threads, one render at a time. A worker
+ * takes its next job as soon as the GL render is done; the encoding of the
+ * previous tile may still be running on the renderer's EncodePool. When the
+ * queue is full, submit() refuses the job so the caller can shed load.
+ *
+ * Requests are coalesced by metatile: while a tile is queued or rendering,
+ * further jobs for any tile of its metatile block attach to it. Each of them
+ * receives its own tile from the one render of the block, instead of
+ * rendering the block again.
+ *
+ * Requests are served by zoom and age: a job is due zoomDelay per zoom level
+ * after it was submitted, and the job due first is rendered first. Low zoom
+ * tiles, which cover most of the screen, overtake deep ones, but a deep tile
+ * that has waited long enough still gets its turn.
+ *
+ * Stale tiles found in the cache are re-rendered by background jobs, which
+ * have a queue of their own that is only served when the request queue is
+ * empty.
+ */
+class RenderPool : private mbgl::util::noncopyable {
+public:
+	// Returns a null pointer if there is no such style; its jobs then fail.
+	using RendererFactory = std::function<std::unique_ptr<RasterTileRenderer> (
+			const std::string& id, const RendererKey&)>;
+
+	struct Stats {
+		std::size_t workers = 0;
+		std::size_t queueDepth = 0;
+		std::size_t queued = 0;
+		std::size_t background = 0;
+		// Jobs taken by a worker, and how long they waited in the queue.
+		uint64_t jobs = 0;
+		// Jobs dropped because all of their requests were obsolete.
+		uint64_t cancelled = 0;
+		// Workers still warming up their renderers.
+		std::size_t warming = 0;
+		std::chrono::duration<double, std::milli> totalWait { 0 };
+		std::chrono::duration<double, std::milli> maximumWait { 0 };
+	};
+
+	static constexpr std::chrono::milliseconds zoomDelay { 25 };
+
+	// The renderers the factory creates render metatiles of up to metatile
+	// tiles square, fitted to maxTextureSize by RendererKey::fitMetatile.
+	RenderPool(std::size_t workers, std::size_t queueDepth, std::size_t renderersPerWorker,
+			RendererFactory factory, unsigned int metatile = 1, unsigned int maxTextureSize = 4096);
+	~RenderPool();
+
+	// Thread safe. Returns false if the queue is full and the tile isn't
+	// already in flight.
+	bool submit(RenderJob job);
+
+	// Has every idle worker create and warm up renderers for the keys, up to
+	// renderersPerWorker of them, before it takes any job. Returns at once.
+	void warmUp(std::vector<RendererKey> keys);
+	// Thread safe. Whether no worker is warming up any more.
+	bool ready() const;
+
+	std::size_t queued();
+	std::size_t getQueueDepth() const;
+	Stats getStats();
+	// One entry for every renderer currently alive.
+	std::vector<RenderStats> getRenderStats();
+
+private:
+	class Worker;
+
+	struct Waiter {
+		TilePath path;
+		RenderCallback callback;
+		std::shared_ptr<const std::atomic<bool>> obsolete;
+	};
+
+	using Queue = std::multimap<std::chrono::steady_clock::time_point, RenderJob>;
+
+	// Identifies the metatile block a tile is rendered in: its style, size,
+	// scale, format, zoom and the block's top left tile.
+	std::string blockKey(const TilePath&) const;
+
+	// Queues a request, ordered by when it is due. Requires the lock.
+	void enqueue(RenderJob job);
+
+	// Whether the job and every request coalesced onto it are obsolete.
+	// Requires the lock.
+	bool isObsolete(const RenderJob& job);
+
+	// Drops the job, collecting the callbacks to answer outside the lock.
+	// Requires the lock.
+	void cancel(RenderJob& job, std::vector<RenderCallback>& callbacks);
+
+	// Drops every obsolete request in the queue. Requires the lock.
+	void purge(std::vector<RenderCallback>& callbacks);
+
+	// Called by a worker on its own thread. Returns false and parks the
+	// worker if there is nothing to do.
+	bool take(Worker* worker, RenderJob& job);
+
+	// Called by a worker when a job is done. Answers the job and every request
+	// coalesced onto it with its tile, from the job's tile or its neighbours,
+	// and returns the number of coalesced requests answered. Requests for a
+	// tile of the block that wasn't rendered, because the job's tile came
+	// from the cache, are submitted again.
+	std::size_t finish(const RenderJob& job, std::shared_ptr<const std::string> data,
+			mbgl::optional<mbgl::Timestamp> expires, Metrics::Outcome outcome,
+			const RasterTileRenderer::Neighbours& neighbours = {});
+
+	// Hands queued work to an idle worker, if there is one. Requires the lock.
+	Worker* dispatch();
+
+	// Called by a worker when it is done warming up.
+	void warmed();
+
+	const std::size_t queueDepth;
+	const std::size_t renderersPerWorker;
+	const unsigned int metatile;
+	const unsigned int maxTextureSize;
+	const RendererFactory factory;
+	std::mutex mutex;
+	Queue queue;
+	std::deque<RenderJob> background;
+	std::vector<Worker*> idle;
+	// Requests waiting on an in-flight job, keyed by blockKey().
+	std::unordered_map<std::string, std::vector<Waiter>> inflight;
+	uint64_t jobs = 0;
+	uint64_t cancelled = 0;
+	std::atomic<std::size_t> warming { 0 };
+	std::chrono::duration<double, std::milli> totalWait { 0 };
+	std::chrono::duration<double, std::milli> maximumWait { 0 };
+	std::vector<std::unique_ptr<Worker>> workers;
+};
+
+}
@@ -0,0 +1,23 @@
+/*
+ */
+#pragma once
+
+#include <folly/io/IOBuf.h>
+
+#include <memory>
+#include <string>
+
+namespace alk {
+
+// Wraps the data in an IOBuf without copying it. The IOBuf keeps its own
+// reference to the data until proxygen is done writing it.
+inline std::unique_ptr<folly::IOBuf> wrapShared(std::shared_ptr<const std::string> data) {
+	auto holder = new std::shared_ptr<const std::string>(data);
+	return folly::IOBuf::takeOwnership(
+			const_cast<char*>(data->data()), data->size(),
+			[] (void*, void* userData) {
+				delete static_cast<std::shared_ptr<const std::string>*>(userData);
+			}, holder);
+}
+
+}
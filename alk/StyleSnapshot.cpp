@@ -0,0 +1,21 @@
+/*
+ */
+#include "StyleSnapshot.hpp"
+
+namespace alk {
+
+std::shared_ptr<const std::string> StyleSnapshot::get(const std::string& url) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = styles.find(url);
+	return it != styles.end() ? it->second : nullptr;
+}
+
+void StyleSnapshot::put(const std::string& url, std::string json) {
+	if (json.empty()) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	styles.emplace(url, std::make_shared<const std::string>(std::move(json)));
+}
+
+}
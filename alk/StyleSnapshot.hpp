@@ -0,0 +1,34 @@
+/*
+ */
+#pragma once
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace alk {
+
+/**
+ * The JSON of the styles the renderers have loaded, by url, so renderers
+ * created later load the style from memory instead of fetching it again.
+ *
+ * Each mbgl::Map still parses the style itself; its parsed layers are bound
+ * to the Map's thread and can't be shared.
+ */
+class StyleSnapshot : private mbgl::util::noncopyable {
+public:
+	// Thread safe. Returns a null pointer if the style hasn't been loaded yet.
+	std::shared_ptr<const std::string> get(const std::string& url);
+
+	// Thread safe. The first JSON stored for a url is kept.
+	void put(const std::string& url, std::string json);
+
+private:
+	std::mutex mutex;
+	std::unordered_map<std::string, std::shared_ptr<const std::string>> styles;
+};
+
+}
@@ -4,6 +4,10 @@
 #include <mbgl/storage/file_source.hpp>
 #include <mbgl/tile/raster_tile.hpp>
 #include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Metrics.hpp"
 #include "TilePath.hpp"
 
 #pragma once
@@ -23,6 +27,14 @@ public:
     mbgl::Bucket* getBucket(const mbgl::style::Layer::Impl&) const;
 	TilePath* path;
 	std::shared_ptr<const std::string> data;
+	// Set when data came from the cache but is past its expiry or was
+	// rendered for another style version.
+	bool stale = false;
+	// The other tiles of the metatile, when the tile was rendered as part
+	// of one.
+	std::vector<std::pair<TilePath, std::shared_ptr<const std::string>>> neighbours;
+	// How the loader found the tile.
+	Metrics::Outcome outcome = Metrics::Outcome::None;
 };
 
 }
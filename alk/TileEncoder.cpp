@@ -0,0 +1,41 @@
+/*
+ */
+#include <stdexcept>
+
+#include "TileEncoder.hpp"
+
+namespace alk {
+
+TileEncoder::TileEncoder() : TileEncoder(Options()) {
+}
+
+TileEncoder::TileEncoder(Options options_)
+	: options(options_),
+	  pngEncoder(options_.png) {
+}
+
+std::string TileEncoder::encode(const mbgl::PremultipliedImage& image, const std::string& format) {
+	if (format.empty() || format == "png") {
+		return pngEncoder.encode(image);
+	} else if (format == "jpg" || format == "jpeg") {
+		return mbgl::encodeJPEG(image, options.jpegQuality);
+	} else if (format == "webp") {
+		return mbgl::encodeWebP(image, options.webpQuality, options.webpLossless);
+	}
+	throw std::invalid_argument("Unsupported tile format: " + format);
+}
+
+bool TileEncoder::isSupported(const std::string& format) {
+	return format.empty() || format == "png" || format == "jpg" || format == "jpeg" || format == "webp";
+}
+
+std::string TileEncoder::contentType(const std::string& format) {
+	if (format == "jpg" || format == "jpeg") {
+		return "image/jpeg";
+	} else if (format == "webp") {
+		return "image/webp";
+	}
+	return "image/png";
+}
+
+}
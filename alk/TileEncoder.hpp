@@ -0,0 +1,41 @@
+/*
+ */
+#pragma once
+
+#include <mbgl/util/image.hpp>
+#include <mbgl/util/png_encoder.hpp>
+
+#include <string>
+
+namespace alk {
+
+/**
+ * Encodes rendered tiles in the format of their TilePath: "png" (the
+ * default), "jpg"/"jpeg" or "webp".
+ *
+ * Not thread safe; the PNG encoder reuses its buffers between tiles.
+ */
+class TileEncoder {
+public:
+	struct Options {
+		mbgl::PNGEncoder::Options png;
+		int jpegQuality = 85;
+		int webpQuality = 80;
+		bool webpLossless = false;
+	};
+
+	TileEncoder();
+	explicit TileEncoder(Options options_);
+
+	// Throws std::invalid_argument for an unsupported format.
+	std::string encode(const mbgl::PremultipliedImage&, const std::string& format);
+
+	static bool isSupported(const std::string& format);
+	static std::string contentType(const std::string& format);
+
+private:
+	const Options options;
+	mbgl::PNGEncoder pngEncoder;
+};
+
+}
@@ -1,60 +1,41 @@
 /*
  */
 #include "TileHandler.hpp"
+#include "AccessLog.hpp"
+#include "SharedIOBuf.hpp"
 
-#include <mbgl/util/run_loop.hpp>
+#include <folly/io/IOBuf.h>
+#include <folly/io/async/EventBaseManager.h>
 #include <proxygen/httpserver/RequestHandler.h>
 #include <proxygen/httpserver/ResponseBuilder.h>
-#include <proxygen/lib/utils/URL.h>
 #include <memory>
-#include <iostream>
-#include <regex>
+#include <sstream>
 #include <string>
 
-#include "Tile.hpp"
-#include "TileLoader.hpp"
-
 using namespace proxygen;
 
 namespace alk {
 
-TileHandler::TileHandler(
-		mbgl::util::RunLoop* loop_,
-		RasterTileRenderer* rasterTileRenderer_) :
-				loop(loop_),
-				rasterTileRenderer(rasterTileRenderer_) {
+TileHandler::TileHandler(RenderPool* renderPool_, TileMemoryCache* memoryCache_,
+		const TileRouter::Match& route) :
+				renderPool(renderPool_),
+				memoryCache(memoryCache_) {
+  // Vector tiles are not rendered here; they are Not Found.
+  if (route.endpoint == TileRouter::Endpoint::Tile && route.format != TileRouter::Format::PBF) {
+	  tilePath_ = new TilePath();
+	  tilePath_->name = route.styleName();
+	  tilePath_->tileSize = route.tileSize;
+	  tilePath_->scale = route.scale;
+	  tilePath_->zoom = route.zoom;
+	  tilePath_->x = route.x;
+	  tilePath_->y = route.y;
+	  tilePath_->format = TileRouter::formatName(route.format);
+  }
 }
 
 void TileHandler::onRequest(std::unique_ptr<HTTPMessage>  headers ) noexcept {
+  begin_ = std::chrono::steady_clock::now();
   request_ = std::move(headers);
-  url_ = proxygen::URL(request_->getURL());
-  std::cout << url_.getUrl() << std::endl;
-  std::string path = url_.getPath();
-  std::smatch m;
-  // Try to match /data/{z}/{x}/{y}.png
-  std::regex pathMatch("/([^/]*)/([0-9]+)/([0-9]+)/([0-9]+)(.(png|jpg))?");
-  if (std::regex_match(path, m, pathMatch)) {
-	  tilePath_ = new TilePath(m[1],m[2],m[3],m[4],m[6]);
-  } else {
-	  // This approach matches ALK style /data?x={x}&y={y}&z={z}
-	  auto q = url_.getQuery();
-	  std::string x,y,z;
-	  if(std::regex_search(q, m, std::regex("x=([0-9]+)"))) {
-		  x = m[1];
-	  }
-	  if(std::regex_search(q, m, std::regex("y=([0-9]+)"))) {
-		  y = m[1];
-	  }
-	  if(std::regex_search(q, m, std::regex("z=([0-9]+)"))) {
-		  z = m[1];
-	  }
-	  if (x != "" && y != "" && z != "") {
-		  // We always assume png here.
-		  tilePath_ = new TilePath(url_.getPath(), z, x, y, "png");
-	  } else {
-		  // tilePath_ is null
-	  }
-  }
 }
 
 void TileHandler::onBody(std::unique_ptr<folly::IOBuf> body) noexcept {
@@ -66,34 +47,93 @@ void TileHandler::onBody(std::unique_ptr<folly::IOBuf> body) noexcept {
 }
 
 void TileHandler::onEOM() noexcept {
-  ResponseBuilder resp(downstream_);
   if (tilePath_ != NULL) {
-	  TileLoader loader(tilePath_, rasterTileRenderer);
-	  pending = true;
-	  loader.load([this, &resp] (Tile& tile) {
-		  try {
-			  if (tile.data) {
-				  resp.status(200, "OK");
-				  resp.body(*tile.data);
-			  } else {
-				  resp.status(500, "Internal Render Error");
-			  }
-		  } catch (std::exception& e) {
-			  resp.status(500, "Internal Render Error");
-		  }
-		  pending = false;
-	  });
-	  // This bit of code ensures that the loop will get run once
-	  // after the loader sets this up on a thread ensuring execution
-	  // of the callback.
-	  while(pending)  {
-		  loop->runOnce();
+	  // Hot tiles are answered straight from memory on this thread.
+	  if (auto data = memoryCache->get(tilePath_->to_s())) {
+		  sendTile(data, Metrics::Outcome::Memory);
+		  return;
 	  }
-	  resp.sendWithEOM();
+	  // The tile is loaded by a render worker. We hand it over to the
+	  // pool and return immediately, so this IO thread is free to serve
+	  // other streams. The result is posted back to our EventBase.
+	  evb_ = folly::EventBaseManager::get()->getEventBase();
+	  folly::EventBase* evb = evb_;
+	  RenderJob job;
+	  job.path = *tilePath_;
+	  job.obsolete = obsolete_;
+	  job.callback = [this, evb] (std::shared_ptr<const std::string> data, mbgl::optional<mbgl::Timestamp> expires,
+			  Metrics::Outcome outcome) {
+		  evb->runInEventBaseThread([this, data, expires, outcome] () {
+			  onTileLoaded(data, expires, outcome);
+		  });
+	  };
+	  pending = renderPool->submit(std::move(job));
+	  if (!pending) {
+		  Metrics::get().increment(Metrics::Counter::Rejected);
+		  ResponseBuilder(downstream_)
+		  	  .status(503, "Service Unavailable: Render Queue Full")
+			  .sendWithEOM();
+		  logRequest(503, 0, Metrics::Outcome::None);
+	  }
+  } else {
+	  ResponseBuilder(downstream_)
+	  	  .status(404, "Not Found: Bad Tile Address")
+		  .sendWithEOM();
+	  logRequest(404, 0, Metrics::Outcome::None);
+  }
+}
+
+void TileHandler::onTileLoaded(std::shared_ptr<const std::string> data, mbgl::optional<mbgl::Timestamp> expires,
+		Metrics::Outcome outcome) noexcept {
+  pending = false;
+  if (aborted) {
+	  // The transaction went away while we were queued or rendering;
+	  // there is nobody to respond to, so just clean up.
+	  delete tilePath_;
+	  delete this;
+	  return;
+  }
+  if (data) {
+	  memoryCache->put(tilePath_->to_s(), data, expires);
+	  sendTile(data, outcome);
   } else {
-	  resp.status(404, "Not Found: Bad Tile Address");
-	  resp.sendWithEOM();
+	  ResponseBuilder(downstream_)
+		  .status(500, "Internal Render Error")
+		  .sendWithEOM();
+	  Metrics::get().record(Metrics::Stage::Request, tilePath_->zoom, Metrics::Outcome::Error,
+			  std::chrono::steady_clock::now() - begin_);
+	  logRequest(500, 0, Metrics::Outcome::Error);
+  }
+}
+
+void TileHandler::sendTile(std::shared_ptr<const std::string> data, Metrics::Outcome outcome) noexcept {
+  ResponseBuilder(downstream_)
+	  .status(200, "OK")
+	  .header("Content-Type", TileEncoder::contentType(tilePath_->format))
+	  .body(wrapShared(data))
+	  .sendWithEOM();
+  Metrics::get().record(Metrics::Stage::Request, tilePath_->zoom, outcome,
+		  std::chrono::steady_clock::now() - begin_);
+  logRequest(200, data->size(), outcome);
+}
+
+void TileHandler::logRequest(uint16_t status, std::size_t bytes, Metrics::Outcome outcome) noexcept {
+  auto& accessLog = AccessLog::get();
+  if (!accessLog.logging(AccessLog::Verbosity::Requests)) {
+	  return;
+  }
+  const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin_;
+  std::ostringstream line;
+  line << "method=" << (request_ ? request_->getMethodString() : "-")
+	   << " url=" << (request_ ? request_->getURL() : "-")
+	   << " status=" << status
+	   << " bytes=" << bytes;
+  if (tilePath_) {
+	  line << " zoom=" << tilePath_->zoom;
   }
+  line << " outcome=" << Metrics::outcomeName(outcome)
+	   << " ms=" << elapsed.count();
+  accessLog.request(line.str());
 }
 
 void TileHandler::onUpgrade(UpgradeProtocol /*protocol*/) noexcept {
@@ -106,6 +146,14 @@ void TileHandler::requestComplete() noexcept {
 }
 
 void TileHandler::onError(ProxygenError /*err*/) noexcept {
+	if (pending) {
+		// The render pool still references us; onTileLoaded will
+		// clean up when the result arrives. Until the tile is taken by a
+		// worker, the job is dropped unless someone else wants it.
+		aborted = true;
+		obsolete_->store(true, std::memory_order_relaxed);
+		return;
+	}
 	delete tilePath_;
 	delete this;
 }
@@ -3,13 +3,18 @@
 #pragma once
 
 #include <folly/Memory.h>
-#include <mbgl/util/run_loop.hpp>
+#include <folly/io/async/EventBase.h>
 #include <proxygen/httpserver/RequestHandler.h>
-#include <proxygen/lib/utils/URL.h>
+#include <atomic>
+#include <chrono>
 #include <memory>
 
-#include "RasterTileRenderer.hpp"
+#include "Metrics.hpp"
+#include "RenderPool.hpp"
+#include "TileEncoder.hpp"
+#include "TileMemoryCache.hpp"
 #include "TilePath.hpp"
+#include "TileRouter.hpp"
 
 namespace proxygen {
 class ResponseHandler;
@@ -19,9 +24,7 @@ namespace alk {
 
 class TileHandler : public proxygen::RequestHandler {
  public:
-  explicit TileHandler(
-			mbgl::util::RunLoop* loop_,
-			RasterTileRenderer* rasterTileRenderer_);
+  TileHandler(RenderPool* renderPool_, TileMemoryCache* memoryCache_, const TileRouter::Match& route);
 
   void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers)
       noexcept override;
@@ -37,13 +40,28 @@ class TileHandler : public proxygen::RequestHandler {
   void onError(proxygen::ProxygenError err) noexcept override;
 
  private:
-  mbgl::util::RunLoop* loop;
-  RasterTileRenderer* rasterTileRenderer;
+  // Called on the EventBase thread once a render worker has produced
+  // the tile (or failed to).
+  void onTileLoaded(std::shared_ptr<const std::string> data, mbgl::optional<mbgl::Timestamp> expires,
+		  Metrics::Outcome outcome) noexcept;
+
+  void sendTile(std::shared_ptr<const std::string> data, Metrics::Outcome outcome) noexcept;
+
+  // Writes the request's line to the access log.
+  void logRequest(uint16_t status, std::size_t bytes, Metrics::Outcome outcome) noexcept;
+
+  RenderPool* renderPool;
+  TileMemoryCache* memoryCache;
   std::unique_ptr<proxygen::HTTPMessage> request_;
   std::unique_ptr<folly::IOBuf> body_;
-  proxygen::URL url_;
   TilePath *tilePath_ = nullptr;
+  std::chrono::steady_clock::time_point begin_;
+  folly::EventBase* evb_ = nullptr;
   bool pending = false;
+  bool aborted = false;
+  // Shared with the render job; set when the client goes away, so the pool
+  // can drop the job if nobody else wants the tile.
+  std::shared_ptr<std::atomic<bool>> obsolete_ = std::make_shared<std::atomic<bool>>(false);
 };
 
 }
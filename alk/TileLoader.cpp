@@ -2,6 +2,8 @@
 #include <mbgl/tile/tile_observer.hpp>
 #include <mbgl/storage/file_source.hpp>
 #include <chrono>
+#include "AccessLog.hpp"
+#include "Metrics.hpp"
 #include "RasterTileRenderer.hpp"
 #include "Tile.hpp"
 #include "TileLoader.hpp"
@@ -10,18 +12,13 @@
 
 namespace alk {
 
-TileLoader::TileLoader(TilePath* tilePath_, RasterTileRenderer* renderer_) :
+TileLoader::TileLoader(TilePath* tilePath_, RasterTileRenderer* renderer_, std::function<void ()> released_) :
 		  tile(tilePath_),
-	      resource(mbgl::Resource::tile(
-	        "/data/{z}/{x}/{y}.png",
-	        renderer_->getPixelRatio(),
-	        tile.path->x,
-	        tile.path->y,
-	        tile.path->zoom,
-	        mbgl::Tileset::Scheme::XYZ,
-	        mbgl::Resource::LoadingMethod::CacheOnly)),
+	      resource(RenderCache::tileResource(*tile.path, renderer_->getPixelRatio())),
 			rasterTileRenderer(renderer_),
-	      renderCache(&renderer_->getRenderCache())
+	      renderCache(&renderer_->getRenderCache()),
+	      policy(renderer_->getExpirationPolicy()),
+	      released(std::move(released_))
 	{
 			assert(!this->request);
 	}
@@ -30,43 +27,85 @@ void TileLoader::load(std::function<void (Tile&)> callback) {
 		fromCacheOrRenderer(callback);
 	}
 
+void TileLoader::revalidate(std::function<void (Tile&)> callback) {
+		auto& accessLog = AccessLog::get();
+		if (accessLog.tracing()) {
+			accessLog.trace(mbgl::Event::Database, "Revalidating " + tile.path->to_s());
+		}
+		tile.outcome = Metrics::Outcome::Miss;
+		mbgl::Response res;
+		loadFromRenderer(res, callback);
+	}
+
 void TileLoader::fromCacheOrRenderer(std::function<void (Tile&)> callback) {
 	    assert(!request);
 
-	    std::cerr << "Load from Cache " << tile.path->to_s() << std::endl;
 	    resource.loadingMethod = mbgl::Resource::LoadingMethod::CacheOnly;
-	    request = renderCache->request(resource, [this, callback](mbgl::Response res) {
+	    const auto begin = std::chrono::steady_clock::now();
+	    request = renderCache->request(resource, [this, callback, begin](mbgl::Response res) {
 	        request.reset();
+	        const auto lookup = std::chrono::steady_clock::now() - begin;
 
-	        if (res.error && res.error->reason == mbgl::Response::Error::Reason::NotFound) {
+	        // Unusable entries come back as NotFound, but still carry their data.
+	        const bool cached = res.data && !res.noContent &&
+	        		(!res.error || res.error->reason == mbgl::Response::Error::Reason::NotFound);
+	        if (cached && policy.isStale(res) && policy.getStaleWhileRevalidate()) {
+	            lookedUp(Metrics::Outcome::Stale, lookup);
+	            loadFromCache(res);
+	            tile.stale = true;
+	            released();
+	            callback(tile);
+	        } else if (cached && !policy.isStale(res)) {
+	            lookedUp(Metrics::Outcome::Hit, lookup);
+	            loadFromCache(res);
+	            released();
+		        callback(tile);
+	        } else if (cached || (res.error && res.error->reason == mbgl::Response::Error::Reason::NotFound)) {
 	            resource.priorModified = res.modified;
 	            resource.priorExpires = res.expires;
 	            resource.priorEtag = res.etag;
 	            resource.priorData = res.data;
-	        	std::cout << "Not Found in Cache " << tile.path->to_s() << std::endl;
+	            lookedUp(Metrics::Outcome::Miss, lookup);
 	            loadFromRenderer(res, [this, callback] (Tile& tile_) {
 	            	callback(tile_);
 	            });
 	        } else {
-	        	std::cout << "Found in Cache " << tile.path->to_s() << std::endl;
+	            lookedUp(Metrics::Outcome::Error, lookup);
 	            loadFromCache(res);
+	            released();
 		        callback(tile);
 	        }
 	    });
 	}
 
+void TileLoader::lookedUp(Metrics::Outcome outcome, Metrics::Duration duration) {
+	tile.outcome = outcome;
+	Metrics::get().record(Metrics::Stage::CacheLookup, tile.path->zoom, outcome, duration);
+	auto& accessLog = AccessLog::get();
+	if (accessLog.tracing()) {
+		accessLog.trace(mbgl::Event::Database, std::string("Cache ") + Metrics::outcomeName(outcome) + " " + tile.path->to_s() +
+				" in " + std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()) + "us");
+	}
+}
+
 void TileLoader::loadFromRenderer(mbgl::Response& response, std::function<void (Tile&)> callback) {
-	rasterTileRenderer->renderTile(tile.path, [this, response, callback] (const std::string data) {
-		mbgl::Timestamp begin = mbgl::util::now();
-		// TODO:: Fix Expired Time
-		tile.setMetadata(begin, begin + std::chrono::hours(30));
-		// We make shared pointer to the data, because the put will be an async task.
-		auto d = std::make_shared<const std::string>(data);
-		tile.setData(d);
+	rasterTileRenderer->renderTile(tile.path, released, [this, response, callback] (std::shared_ptr<const std::string> d,
+			RasterTileRenderer::Neighbours neighbours) {
+		if (!d) {
+			// The renderer logged why; the tile has no data, so it's answered
+			// as an error.
+			tile.outcome = Metrics::Outcome::Error;
+			callback(tile);
+			return;
+		}
 		mbgl::Response resp;
+		policy.stamp(resp, tile.path->zoom);
+		tile.setMetadata(resp.modified, resp.expires);
+		// The data is shared, because the put will be an async task.
+		tile.setData(d);
+		tile.neighbours = std::move(neighbours);
 		resp.noContent = false;
 		resp.data = d;
-		resp.mustRevalidate = false;
 		// This is an async task that will be executing on another thread.
 		// It will release the shared object;
 		renderCache->put(resource, resp);
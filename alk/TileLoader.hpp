@@ -1,6 +1,7 @@
 
 #include <mbgl/tile/tile_observer.hpp>
 #include <mbgl/storage/file_source.hpp>
+#include "Metrics.hpp"
 #include "RasterTileRenderer.hpp"
 #include "RenderCache.hpp"
 #include "Tile.hpp"
@@ -11,18 +12,28 @@ namespace alk {
 
 class TileLoader {
 public:
-	TileLoader(TilePath *tilePath_, RasterTileRenderer* renderer_);
+	// released is called on the renderer's thread once the loader no longer
+	// needs the renderer, which may be before the tile is done encoding.
+	TileLoader(TilePath *tilePath_, RasterTileRenderer* renderer_, std::function<void ()> released_);
+	// Loads the tile from the cache, rendering it if it isn't there. Stale
+	// tiles are rendered too, unless the policy allows serving them.
 	void load(std::function<void (Tile&)> callback);
+	// Renders the tile and refreshes the cache, regardless of what's in it.
+	void revalidate(std::function<void (Tile&)> callback);
 private:
 	void fromCacheOrRenderer(std::function<void (Tile&)> callback) ;
 	void loadFromRenderer(mbgl::Response& res, std::function<void (Tile&)> callback);
 	void loadFromCache(const mbgl::Response& res);
+	// Records how the cache lookup went.
+	void lookedUp(Metrics::Outcome outcome, Metrics::Duration duration);
 	Tile tile;
     mbgl::Resource resource;
     RasterTileRenderer* rasterTileRenderer;
     RenderCache* renderCache;
+    const ExpirationPolicy& policy;
     std::unique_ptr<mbgl::AsyncRequest> request;
     std::function<void (Tile&)> dataCallback;
+    std::function<void ()> released;
 };
 
 
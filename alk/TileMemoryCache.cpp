@@ -0,0 +1,93 @@
+/*
+ */
+#include <functional>
+#include <iterator>
+
+#include "TileMemoryCache.hpp"
+
+namespace alk {
+
+TileMemoryCache::TileMemoryCache(std::size_t budget_, std::size_t shards_)
+	: budget(budget_),
+	  shardBudget(shards_ ? budget_ / shards_ : 0) {
+	shards.reserve(shards_);
+	for (std::size_t i = 0; i < shards_; ++i) {
+		shards.emplace_back(std::make_unique<Shard>());
+	}
+}
+
+TileMemoryCache::Shard& TileMemoryCache::shardFor(const std::string& key) {
+	return *shards[std::hash<std::string>()(key) % shards.size()];
+}
+
+std::shared_ptr<const std::string> TileMemoryCache::get(const std::string& key) {
+	if (!shardBudget) {
+		return nullptr;
+	}
+
+	Shard& shard = shardFor(key);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto it = shard.index.find(key);
+	if (it == shard.index.end()) {
+		shard.misses++;
+		return nullptr;
+	}
+	auto entry = it->second;
+	if (entry->expires && *entry->expires <= mbgl::util::now()) {
+		shard.erase(entry);
+		shard.misses++;
+		return nullptr;
+	}
+	shard.hits++;
+	// Move the entry to the front of the LRU list.
+	shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+	return entry->data;
+}
+
+void TileMemoryCache::put(const std::string& key, std::shared_ptr<const std::string> data,
+		mbgl::optional<mbgl::Timestamp> expires) {
+	if (!shardBudget || !data || data->size() > shardBudget) {
+		return;
+	}
+	if (expires && *expires <= mbgl::util::now()) {
+		return;
+	}
+
+	Shard& shard = shardFor(key);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto it = shard.index.find(key);
+	if (it != shard.index.end()) {
+		shard.erase(it->second);
+	}
+
+	shard.bytes += data->size();
+	shard.lru.push_front({ key, std::move(data), expires });
+	shard.index.emplace(key, shard.lru.begin());
+
+	while (shard.bytes > shardBudget) {
+		shard.erase(std::prev(shard.lru.end()));
+		shard.evictions++;
+	}
+}
+
+void TileMemoryCache::Shard::erase(std::list<Entry>::iterator entry) {
+	bytes -= entry->data->size();
+	index.erase(entry->key);
+	lru.erase(entry);
+}
+
+TileMemoryCache::Stats TileMemoryCache::getStats() {
+	Stats stats;
+	stats.budget = budget;
+	for (auto& shard : shards) {
+		std::lock_guard<std::mutex> lock(shard->mutex);
+		stats.bytes += shard->bytes;
+		stats.entries += shard->index.size();
+		stats.hits += shard->hits;
+		stats.misses += shard->misses;
+		stats.evictions += shard->evictions;
+	}
+	return stats;
+}
+
+}
@@ -0,0 +1,80 @@
+/*
+ */
+#pragma once
+
+#include <mbgl/util/chrono.hpp>
+#include <mbgl/util/noncopyable.hpp>
+#include <mbgl/util/optional.hpp>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace alk {
+
+/**
+ * An in-process, memory budgeted cache of encoded tiles that sits in front
+ * of the SQLite RenderCache.
+ *
+ * Entries are spread over a number of independently locked shards, each an
+ * LRU list holding its share of the byte budget. Tiles are handed out as the
+ * shared pointer they were stored with, so a hit involves no copy. Entries
+ * past their expiration are dropped on lookup, so a stale tile goes back
+ * through the RenderCache and its revalidation.
+ */
+class TileMemoryCache : private mbgl::util::noncopyable {
+public:
+	struct Stats {
+		std::size_t budget = 0;
+		std::size_t bytes = 0;
+		std::size_t entries = 0;
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+	};
+
+	// A budget of 0 disables the cache.
+	TileMemoryCache(std::size_t budget, std::size_t shards = 16);
+
+	// Thread safe. Returns nullptr on a miss.
+	std::shared_ptr<const std::string> get(const std::string& key);
+
+	// Thread safe. Replaces any existing entry for the key. Tiles that
+	// have already expired are not stored.
+	void put(const std::string& key, std::shared_ptr<const std::string> data,
+			mbgl::optional<mbgl::Timestamp> expires = {});
+
+	Stats getStats();
+
+private:
+	struct Entry {
+		std::string key;
+		std::shared_ptr<const std::string> data;
+		mbgl::optional<mbgl::Timestamp> expires;
+	};
+
+	struct Shard {
+		std::mutex mutex;
+		std::list<Entry> lru;
+		std::unordered_map<std::string, std::list<Entry>::iterator> index;
+		std::size_t bytes = 0;
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+
+		void erase(std::list<Entry>::iterator);
+	};
+
+	Shard& shardFor(const std::string& key);
+
+	const std::size_t budget;
+	const std::size_t shardBudget;
+	std::vector<std::unique_ptr<Shard>> shards;
+};
+
+}
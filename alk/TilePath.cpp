@@ -16,9 +16,13 @@ TilePath::TilePath(std::string n, std::string z, std::string x1, std::string y1,
 		format = fmt;
 }
 
-std::string TilePath::to_s() {
+std::string TilePath::to_s() const {
 		std::ostringstream s;
-		s << name << "/" << zoom << "/" << x << "/" << y << "." << format;
+		s << name << "/" << tileSize << "/" << zoom << "/" << x << "/" << y;
+		if (scale != 1) {
+			s << "@" << scale << "x";
+		}
+		s << "." << format;
 		return s.str();
 }
 
@@ -12,8 +12,11 @@ public:
 	unsigned long long x;
 	unsigned long long y;
 	std::string format;
+	// Logical size of the tile in pixels, and the density it's rendered at.
+	unsigned int tileSize = 512;
+	unsigned int scale = 1;
 	explicit TilePath();
 	explicit TilePath(std::string n, std::string z, std::string x1, std::string y1, std::string fmt);
-	std::string to_s();
+	std::string to_s() const;
 };
 }
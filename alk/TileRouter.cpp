@@ -0,0 +1,339 @@
+/*
+ */
+#include <algorithm>
+#include <cstring>
+
+#include "TileRouter.hpp"
+
+namespace alk {
+
+constexpr uint32_t TileRouter::maxZoom;
+constexpr uint32_t TileRouter::maxScale;
+
+namespace {
+
+// Parses a run of digits at it, without overflowing. Returns false if there
+// are none, or they don't fit.
+bool parseNumber(const char*& it, const char* end, uint64_t& value) {
+	const char* begin = it;
+	value = 0;
+	while (it != end && *it >= '0' && *it <= '9') {
+		if (it - begin >= 18) {
+			return false;
+		}
+		value = value * 10 + (*it - '0');
+		++it;
+	}
+	return it != begin;
+}
+
+bool equals(const char* begin, const char* end, const char* literal) {
+	const std::size_t length = std::strlen(literal);
+	return std::size_t(end - begin) == length && std::memcmp(begin, literal, length) == 0;
+}
+
+// Skips the literal prefix at it, if it's there.
+bool skip(const char*& it, const char* end, const char* literal) {
+	const std::size_t length = std::strlen(literal);
+	if (std::size_t(end - it) < length || std::memcmp(it, literal, length) != 0) {
+		return false;
+	}
+	it += length;
+	return true;
+}
+
+// Parses /{z}/{x}/{y} of a tile at it.
+bool parseTile(const char*& it, const char* end, uint64_t& z, uint64_t& x, uint64_t& y, uint32_t maxZoom) {
+	for (uint64_t* value : { &z, &x, &y }) {
+		if (it == end || *it++ != '/' || !parseNumber(it, end, *value)) {
+			return false;
+		}
+	}
+	return z <= maxZoom && x < (uint64_t(1) << z) && y < (uint64_t(1) << z);
+}
+
+bool contains(const std::vector<uint32_t>& values, uint64_t value) {
+	return std::find(values.begin(), values.end(), value) != values.end();
+}
+
+} // namespace
+
+TileRouter::TileRouter() = default;
+
+TileRouter::TileRouter(std::vector<std::string> styles_, uint32_t defaultTileSize_,
+		std::vector<uint32_t> tileSizes_, std::vector<uint32_t> scales_)
+	: styles(std::move(styles_)),
+	  defaultTileSize(defaultTileSize_),
+	  tileSizes(std::move(tileSizes_)),
+	  scales(std::move(scales_)) {
+}
+
+TileRouter::Match TileRouter::match(const std::string& path, const std::string& query) const {
+	Match result;
+	if (path == "/stats") {
+		result.endpoint = Endpoint::Stats;
+	} else if (path == "/stats/cache") {
+		result.endpoint = Endpoint::CacheStats;
+	} else if (path == "/stats/pipeline") {
+		result.endpoint = Endpoint::PipelineStats;
+	} else if (path == "/metrics") {
+		result.endpoint = Endpoint::Metrics;
+	} else if (path == "/ready") {
+		result.endpoint = Endpoint::Ready;
+	} else if (path.compare(0, 8, "/vector/") == 0) {
+		if (matchVectorTile(path.data() + 8, path.data() + path.size(), result)) {
+			result.endpoint = Endpoint::VectorTile;
+		} else {
+			result = Match();
+		}
+	} else if (path.compare(0, 7, "/fonts/") == 0) {
+		if (matchGlyphs(path.data() + 7, path.data() + path.size(), result)) {
+			result.endpoint = Endpoint::Glyphs;
+		} else {
+			result = Match();
+		}
+	} else if (path.compare(0, 9, "/sprites/") == 0) {
+		if (matchSprite(path.data() + 9, path.data() + path.size(), result)) {
+			result.endpoint = Endpoint::Sprite;
+		} else {
+			result = Match();
+		}
+	} else if (matchPath(path.data(), path.data() + path.size(), result)) {
+		result.endpoint = Endpoint::Tile;
+	} else {
+		result = Match();
+		// The ALK form names the style with the whole path.
+		if (path.size() > 1 && path[0] == '/' &&
+				matchStyle(path.data() + 1, path.size() - 1, result) &&
+				matchQuery(query.data(), query.data() + query.size(), result)) {
+			result.endpoint = Endpoint::Tile;
+		} else {
+			result = Match();
+		}
+	}
+	return result;
+}
+
+const char* TileRouter::formatName(Format format) {
+	switch (format) {
+	case Format::PNG:
+		return "png";
+	case Format::JPEG:
+		return "jpg";
+	case Format::WebP:
+		return "webp";
+	case Format::PBF:
+		return "pbf";
+	case Format::JSON:
+		return "json";
+	}
+	return "png";
+}
+
+bool TileRouter::matchStyle(const char* begin, std::size_t length, Match& result) const {
+	if (length == 0) {
+		return false;
+	}
+	result.style = begin;
+	result.styleLength = length;
+	if (styles.empty()) {
+		return true;
+	}
+	for (std::size_t i = 0; i < styles.size(); ++i) {
+		if (styles[i].size() == length && std::memcmp(styles[i].data(), begin, length) == 0) {
+			result.styleIndex = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool TileRouter::matchPath(const char* it, const char* end, Match& result) const {
+	if (it == end || *it++ != '/') {
+		return false;
+	}
+	const char* style = it;
+	while (it != end && *it != '/') {
+		++it;
+	}
+	if (it == end || !matchStyle(style, it - style, result)) {
+		return false;
+	}
+
+	// Three numbers are z/x/y; four are size/z/x/y.
+	uint64_t numbers[4];
+	std::size_t count = 0;
+	while (count < 4 && it != end && *it == '/') {
+		++it;
+		if (!parseNumber(it, end, numbers[count++])) {
+			return false;
+		}
+	}
+	if (count < 3 || (it != end && *it == '/')) {
+		return false;
+	}
+	uint64_t size = defaultTileSize;
+	if (count == 4) {
+		size = numbers[0];
+		if (size != defaultTileSize && !contains(tileSizes, size)) {
+			return false;
+		}
+	}
+	const uint64_t z = numbers[count - 3];
+	const uint64_t x = numbers[count - 2];
+	const uint64_t y = numbers[count - 1];
+	if (z > maxZoom || x >= (uint64_t(1) << z) || y >= (uint64_t(1) << z)) {
+		return false;
+	}
+	result.tileSize = size;
+	result.zoom = z;
+	result.x = x;
+	result.y = y;
+
+	if (it != end && *it == '@') {
+		uint64_t scale;
+		++it;
+		if (!parseNumber(it, end, scale) || (scale != 1 && !contains(scales, scale)) || it == end || *it++ != 'x') {
+			return false;
+		}
+		result.scale = scale;
+	}
+
+	if (it == end) {
+		result.format = Format::PNG;
+		return true;
+	}
+	if (*it++ != '.') {
+		return false;
+	}
+	if (equals(it, end, "png")) {
+		result.format = Format::PNG;
+	} else if (equals(it, end, "jpg") || equals(it, end, "jpeg")) {
+		result.format = Format::JPEG;
+	} else if (equals(it, end, "webp")) {
+		result.format = Format::WebP;
+	} else if (equals(it, end, "pbf")) {
+		result.format = Format::PBF;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+bool TileRouter::matchQuery(const char* it, const char* end, Match& result) const {
+	uint64_t values[3];
+	bool found[3] = { false, false, false };
+	while (it != end) {
+		const char* key = it;
+		while (it != end && *it != '=' && *it != '&') {
+			++it;
+		}
+		const char* keyEnd = it;
+		std::size_t index = 3;
+		if (keyEnd - key == 1) {
+			index = *key == 'x' ? 0 : *key == 'y' ? 1 : *key == 'z' ? 2 : 3;
+		}
+		if (it != end && *it == '=') {
+			++it;
+			if (index < 3) {
+				uint64_t value;
+				if (!parseNumber(it, end, value) || (it != end && *it != '&')) {
+					return false;
+				}
+				values[index] = value;
+				found[index] = true;
+			}
+		}
+		// Skip the rest of this parameter.
+		while (it != end && *it != '&') {
+			++it;
+		}
+		if (it != end) {
+			++it;
+		}
+	}
+
+	if (!found[0] || !found[1] || !found[2]) {
+		return false;
+	}
+	const uint64_t z = values[2];
+	if (z > maxZoom || values[0] >= (uint64_t(1) << z) || values[1] >= (uint64_t(1) << z)) {
+		return false;
+	}
+	result.tileSize = defaultTileSize;
+	result.zoom = z;
+	result.x = values[0];
+	result.y = values[1];
+	result.scale = 1;
+	result.format = Format::PNG;
+	return true;
+}
+
+bool TileRouter::matchVectorTile(const char* it, const char* end, Match& result) const {
+	const char* source = it;
+	while (it != end && *it != '/') {
+		++it;
+	}
+	if (it == source) {
+		return false;
+	}
+	result.style = source;
+	result.styleLength = it - source;
+
+	uint64_t z, x, y;
+	if (!parseTile(it, end, z, x, y, maxZoom) || !equals(it, end, ".pbf")) {
+		return false;
+	}
+	result.zoom = z;
+	result.x = x;
+	result.y = y;
+	result.format = Format::PBF;
+	return true;
+}
+
+bool TileRouter::matchGlyphs(const char* it, const char* end, Match& result) const {
+	const char* stack = it;
+	while (it != end && *it != '/') {
+		++it;
+	}
+	if (it == stack || it == end) {
+		return false;
+	}
+	result.style = stack;
+	result.styleLength = it - stack;
+	++it;
+
+	// Ranges are blocks of 256 code points, as mbgl and GL JS request them.
+	uint64_t first, last;
+	if (!parseNumber(it, end, first) || it == end || *it++ != '-' || !parseNumber(it, end, last) ||
+			first % 256 != 0 || last != first + 255 || last > 0xFFFF || !equals(it, end, ".pbf")) {
+		return false;
+	}
+	result.glyphs = first;
+	result.format = Format::PBF;
+	return true;
+}
+
+bool TileRouter::matchSprite(const char* it, const char* end, Match& result) const {
+	const char* style = it;
+	while (it != end && *it != '/' && *it != '@' && *it != '.') {
+		++it;
+	}
+	if (it == style || it == end) {
+		return false;
+	}
+	result.style = style;
+	result.styleLength = it - style;
+
+	result.scale = skip(it, end, "@2x") ? 2 : 1;
+	if (equals(it, end, ".json")) {
+		result.format = Format::JSON;
+	} else if (equals(it, end, ".png")) {
+		result.format = Format::PNG;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+}
@@ -0,0 +1,111 @@
+/*
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace alk {
+
+/**
+ * Maps request paths to the server's endpoints and parses tile addresses.
+ *
+ * Tiles are addressed either as
+ *
+ *     /{style}[/{256|512}]/{z}/{x}/{y}[@{n}x][.{png|jpg|jpeg|webp|pbf}]
+ *
+ * or in the ALK form, /{style}?x={x}&y={y}&z={z}, which is always png.
+ * Tiles without a size have the router's default size, and tiles without a
+ * scale are 1x. Other sizes and scales are only matched if the router was
+ * constructed with them, as each combination needs renderers of its own.
+ *
+ * The assets clients need to render the vector tiles themselves are at
+ *
+ *     /vector/{source}/{z}/{x}/{y}.pbf
+ *     /fonts/{fontstack}/{start}-{end}.pbf
+ *     /sprites/{style}[@2x].{json|png}
+ *
+ * and are not checked against the router's styles.
+ *
+ * Matching is a single hand-written pass over the path and query and does
+ * not allocate, so it is cheap enough to run for every request on the IO
+ * threads. A router constructed with style names only matches those styles;
+ * without any, every style name is accepted.
+ */
+class TileRouter {
+public:
+	enum class Endpoint : uint8_t {
+		NotFound,
+		Tile,
+		Stats,
+		CacheStats,
+		PipelineStats,
+		Metrics,
+		Ready,
+		VectorTile,
+		Glyphs,
+		Sprite,
+	};
+
+	enum class Format : uint8_t {
+		PNG,
+		JPEG,
+		WebP,
+		PBF,
+		JSON,
+	};
+
+	struct Match {
+		Endpoint endpoint = Endpoint::NotFound;
+		// Points into the matched path; only valid while the path is. This
+		// is the source of vector tiles and the still percent-encoded font
+		// stack of glyphs.
+		const char* style = nullptr;
+		std::size_t styleLength = 0;
+		// Index of the style in the router's list, if it has one.
+		std::size_t styleIndex = 0;
+		uint32_t tileSize = 0;
+		uint32_t zoom = 0;
+		uint64_t x = 0;
+		uint64_t y = 0;
+		uint32_t scale = 1;
+		Format format = Format::PNG;
+		// The first code point of a range of glyphs.
+		uint32_t glyphs = 0;
+
+		std::string styleName() const {
+			return std::string(style, styleLength);
+		}
+	};
+
+	// Tiles deeper than this are rejected, as are routers with larger scales.
+	static constexpr uint32_t maxZoom = 30;
+	static constexpr uint32_t maxScale = 4;
+
+	TileRouter();
+	// tileSizes and scales are those matched besides the default size and 1x.
+	explicit TileRouter(std::vector<std::string> styles, uint32_t defaultTileSize = 512,
+			std::vector<uint32_t> tileSizes = { 256, 512 }, std::vector<uint32_t> scales = { 1, 2 });
+
+	Match match(const std::string& path, const std::string& query) const;
+
+	// The extension tiles of the format are stored and served under.
+	static const char* formatName(Format);
+
+private:
+	bool matchStyle(const char* begin, std::size_t length, Match&) const;
+	bool matchPath(const char* begin, const char* end, Match&) const;
+	bool matchQuery(const char* begin, const char* end, Match&) const;
+	bool matchVectorTile(const char* begin, const char* end, Match&) const;
+	bool matchGlyphs(const char* begin, const char* end, Match&) const;
+	bool matchSprite(const char* begin, const char* end, Match&) const;
+
+	const std::vector<std::string> styles;
+	const uint32_t defaultTileSize = 512;
+	const std::vector<uint32_t> tileSizes = { 256, 512 };
+	const std::vector<uint32_t> scales = { 1, 2 };
+};
+
+}
@@ -0,0 +1,526 @@
+/*
+ * Renders every tile of an area into the RenderCache ahead of traffic.
+ */
+#include <mbgl/storage/default_file_source.hpp>
+#include <mbgl/tile/tile_id.hpp>
+#include <mbgl/util/geo.hpp>
+#include <mbgl/util/geojson.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/tile_cover.hpp>
+
+#include <mapbox/geometry/for_each_point.hpp>
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "AccessLog.hpp"
+#include "EncodePool.hpp"
+#include "ExpirationPolicy.hpp"
+#include "RasterTileRenderer.hpp"
+#include "RenderCache.hpp"
+#include "RenderPool.hpp"
+#include "StyleSnapshot.hpp"
+#include "SourcesFileSource.hpp"
+#include "SourcesDefaultFileSource.hpp"
+#include "SourcesSpecLoader.hpp"
+#include "TileEncoder.hpp"
+#include "TileRouter.hpp"
+
+namespace po = boost::program_options;
+
+using namespace alk;
+
+namespace {
+
+// One unit of work: a tile to render, and how many tiles of the cover it
+// stands for. With metatiles, rendering any tile of a block fills in the
+// rest of the block, so only one tile per block is submitted.
+struct SeedJob {
+	TilePath path;
+	std::size_t tiles;
+};
+
+// Distance of (x, y) along the Hilbert curve filling a 2^order square.
+uint64_t hilbertIndex(uint32_t order, uint64_t x, uint64_t y) {
+	const uint64_t n = uint64_t(1) << order;
+	uint64_t d = 0;
+	for (uint64_t s = n / 2; s > 0; s /= 2) {
+		const uint64_t rx = (x & s) > 0;
+		const uint64_t ry = (y & s) > 0;
+		d += s * s * ((3 * rx) ^ ry);
+		if (ry == 0) {
+			if (rx == 1) {
+				x = n - 1 - x;
+				y = n - 1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return d;
+}
+
+mbgl::LatLngBounds parseBBox(const std::string& bbox) {
+	double west, south, east, north;
+	char c1, c2, c3;
+	std::istringstream in(bbox);
+	if (!(in >> west >> c1 >> south >> c2 >> east >> c3 >> north) || c1 != ',' || c2 != ',' || c3 != ',') {
+		throw std::runtime_error("Bounding box must be given as west,south,east,north");
+	}
+	if (south > north || std::abs(west) > 180 || std::abs(east) > 180) {
+		throw std::runtime_error("Bounding box must have south <= north and longitudes between -180 and 180");
+	}
+	// A box with west > east crosses the antimeridian. Its east edge is
+	// unwrapped past 180, and planJobs() wraps the tiles back.
+	if (west > east) {
+		east += 360;
+	}
+	return mbgl::LatLngBounds::hull(mbgl::LatLng(south, west), mbgl::LatLng(north, east));
+}
+
+// The bounds of all geometries in a GeoJSON file. Their longitudes are
+// covered by the narrowest range, which crosses the antimeridian if that is
+// narrower than the one that doesn't.
+mbgl::LatLngBounds parseGeoJSONBounds(const std::string& file) {
+	const mbgl::GeoJSON geojson = mapbox::geojson::parse(mbgl::util::read_file(file));
+	std::vector<double> longitudes;
+	double south = 90, north = -90;
+	auto extend = [&] (const mapbox::geojson::geometry& geometry) {
+		mapbox::geometry::for_each_point(geometry, [&] (const mapbox::geometry::point<double>& p) {
+			const mbgl::LatLng point(p.y, p.x, mbgl::LatLng::Wrapped);
+			longitudes.push_back(point.longitude());
+			south = std::min(south, point.latitude());
+			north = std::max(north, point.latitude());
+		});
+	};
+	geojson.match(
+		[&] (const mapbox::geojson::geometry& geometry) { extend(geometry); },
+		[&] (const mapbox::geojson::feature& feature) { extend(feature.geometry); },
+		[&] (const mapbox::geojson::feature_collection& features) {
+			for (const auto& feature : features) {
+				extend(feature.geometry);
+			}
+		});
+	if (longitudes.empty()) {
+		throw std::runtime_error("No coordinates in " + file);
+	}
+
+	// The range starts after the widest gap between the longitudes. The gap
+	// across the antimeridian is from the last one to the first one.
+	std::sort(longitudes.begin(), longitudes.end());
+	double west = longitudes.front();
+	double east = longitudes.back();
+	double widest = west + 360 - east;
+	for (std::size_t i = 1; i < longitudes.size(); ++i) {
+		const double gap = longitudes[i] - longitudes[i - 1];
+		if (gap > widest) {
+			widest = gap;
+			west = longitudes[i];
+			east = longitudes[i - 1] + 360;
+		}
+	}
+	return mbgl::LatLngBounds::hull(mbgl::LatLng(south, west), mbgl::LatLng(north, east));
+}
+
+// Lists the jobs for the bounds zoom by zoom, each zoom in Hilbert (or row)
+// order of its metatile blocks, so consecutive renders share sources, glyphs
+// and sprites. The jobs' paths copy the style, size, scale and format of tile.
+std::vector<SeedJob> planJobs(const mbgl::LatLngBounds& bounds, unsigned int minZoom, unsigned int maxZoom,
+		unsigned int metatile, bool hilbert, const TilePath& tile) {
+	std::vector<SeedJob> jobs;
+	for (unsigned int z = minZoom; z <= maxZoom; z++) {
+		// Blocks are aligned to multiples of n, as RasterTileRenderer renders them.
+		uint32_t order = 0;
+		while ((1u << order) < metatile && order < z) {
+			order++;
+		}
+		const uint64_t n = uint64_t(1) << order;
+
+		// A bounds crossing the antimeridian covers wrapped tiles; only
+		// the canonical ones exist in the cache.
+		std::set<std::pair<uint64_t, uint64_t>> tiles;
+		for (const auto& tile : mbgl::util::tileCover(bounds, z)) {
+			tiles.emplace(tile.canonical.x, tile.canonical.y);
+		}
+
+		// Count the covered tiles of each block.
+		std::map<std::pair<uint64_t, uint64_t>, std::size_t> blockTiles;
+		for (const auto& tile : tiles) {
+			blockTiles[{ tile.first / n, tile.second / n }]++;
+		}
+
+		struct Block {
+			uint64_t key;
+			uint64_t x;
+			uint64_t y;
+			std::size_t tiles;
+		};
+		std::vector<Block> blocks;
+		blocks.reserve(blockTiles.size());
+		for (const auto& block : blockTiles) {
+			const uint64_t bx = block.first.first;
+			const uint64_t by = block.first.second;
+			const uint64_t key = hilbert ? hilbertIndex(z - order, bx, by) : (by << 32) | bx;
+			blocks.push_back({ key, bx, by, block.second });
+		}
+		std::sort(blocks.begin(), blocks.end(), [] (const Block& a, const Block& b) {
+			return a.key < b.key;
+		});
+
+		for (const auto& block : blocks) {
+			SeedJob job;
+			job.path = tile;
+			job.path.zoom = z;
+			job.path.x = block.x * n;
+			job.path.y = block.y * n;
+			job.tiles = block.tiles;
+			jobs.push_back(job);
+		}
+	}
+	return jobs;
+}
+
+// The progress file holds a description of the seed and the number of jobs,
+// in order, that have completed. A seed with a different description starts
+// over.
+std::size_t readProgress(const std::string& file, const std::string& description) {
+	std::ifstream in(file);
+	std::string line;
+	std::size_t done = 0;
+	if (!std::getline(in, line) || line != description || !(in >> done)) {
+		return 0;
+	}
+	return done;
+}
+
+void writeProgress(const std::string& file, const std::string& description, std::size_t done) {
+	const std::string tmp = file + ".tmp";
+	{
+		std::ofstream out(tmp, std::ios::trunc);
+		out << description << std::endl << done << std::endl;
+	}
+	std::rename(tmp.c_str(), file.c_str());
+}
+
+}
+
+int main(int argc, char* argv[]) {
+	std::string style_url;
+	std::string bbox;
+	std::string geojson_file;
+	unsigned int min_zoom = 0;
+	unsigned int max_zoom = 14;
+	std::string order = "hilbert";
+	std::string format = "png";
+	std::string progress_file = "";
+	unsigned int report_interval = 10;
+	bool force = false;
+	unsigned int render_threads = 4;
+	unsigned int render_workers = 1;
+	unsigned int queue_depth = 64;
+	unsigned int encode_workers = 0;
+	std::string raster_cache_file = "raster.cache";
+	std::string vector_cache_file = "vector.cache";
+	std::string sources_map_file = "";
+	std::string asset_root = ".";
+	unsigned int raster_cache_limit = 1024;
+	unsigned int raster_cache_batch = 256;
+	unsigned int raster_cache_flush = 1000;
+	bool raster_cache_wal = false;
+	unsigned int vector_cache_limit = 1024;
+	unsigned int tile_size = 512;
+	unsigned int scale = 1;
+	std::string style_name = "data";
+	int png_level = 6;
+	bool png8 = false;
+	int jpeg_quality = 85;
+	int webp_quality = 80;
+	bool webp_lossless = false;
+	unsigned int metatile = 4;
+	unsigned int max_texture_size = 4096;
+	unsigned int ttl = 30;
+	std::vector<std::string> ttl_zooms;
+	std::string style_version;
+	std::string log_level = "off";
+	std::string program_cache_dir;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+		("style,s", po::value(&style_url)->required()->value_name("url"), "Mapbox Stylesheet URL")
+		("style-name", po::value(&style_name)->value_name("name")->default_value(style_name), "Name the style is served under by alk-rts")
+		("bbox,B", po::value(&bbox)->value_name("west,south,east,north"), "Area to seed")
+		("geojson,g", po::value(&geojson_file)->value_name("path"), "Area to seed, as the bounds of a GeoJSON file")
+		("min-zoom", po::value(&min_zoom)->value_name("integer")->default_value(min_zoom), "Lowest zoom level to seed")
+		("max-zoom", po::value(&max_zoom)->value_name("integer")->default_value(max_zoom), "Highest zoom level to seed")
+		("format,F", po::value(&format)->value_name("png|jpg|webp")->default_value(format), "Tile format")
+		("order,o", po::value(&order)->value_name("hilbert|row")->default_value(order), "Order in which tiles of a zoom level are rendered")
+		("progress,P", po::value(&progress_file)->value_name("path"), "File recording progress, to resume an interrupted seed")
+		("report-interval", po::value(&report_interval)->value_name("seconds")->default_value(report_interval), "Seconds between throughput reports")
+		("force,f", po::bool_switch(&force), "Render tiles even if they are fresh in the Raster Cache")
+		("tile-size,z", po::value(&tile_size)->value_name("integer")->default_value(tile_size), "TileSize (256,512)")
+		("scale", po::value(&scale)->value_name("integer")->default_value(scale), "Pixel density of the tiles (1-4), served as @{scale}x")
+		("metatile,M", po::value(&metatile)->value_name("integer")->default_value(metatile), "Metatile size (1,2,4,8). Renders NxN tiles per pass")
+		("max-texture-size", po::value(&max_texture_size)->value_name("pixels")->default_value(max_texture_size), "Largest framebuffer the GL renderers may use. Metatiles are made smaller to fit it")
+		("png-level", po::value(&png_level)->value_name("integer")->default_value(png_level), "PNG deflate level, from 0 (fastest) to 9 (smallest)")
+		("png8", po::bool_switch(&png8), "Quantize tiles to 8-bit palette PNGs")
+		("jpeg-quality", po::value(&jpeg_quality)->value_name("integer")->default_value(jpeg_quality), "JPEG quality, from 0 to 100")
+		("webp-quality", po::value(&webp_quality)->value_name("integer")->default_value(webp_quality), "WebP quality, from 0 to 100")
+		("webp-lossless", po::bool_switch(&webp_lossless), "Encode WebP tiles losslessly")
+		("render-workers,w", po::value(&render_workers)->value_name("integer")->default_value(render_workers), "Number of Render Workers (GL contexts)")
+		("render-threads,T", po::value(&render_threads)->value_name("integer")->default_value(render_threads), "Number of Render Threads per Render Worker")
+		("queue-depth,q", po::value(&queue_depth)->value_name("integer")->default_value(queue_depth), "Maximum queued tile jobs")
+		("encode-workers", po::value(&encode_workers)->value_name("integer")->default_value(encode_workers), "Number of Tile Encoding Threads (0 = number of CPUs)")
+		("raster-cache,r", po::value(&raster_cache_file)->value_name("sqlite3")->default_value(raster_cache_file), "Raster Tile Cache File")
+		("raster-cache-limit,R", po::value(&raster_cache_limit)->value_name("Mb")->default_value(raster_cache_limit), "Raster Cache Limit")
+		("raster-cache-batch", po::value(&raster_cache_batch)->value_name("integer")->default_value(raster_cache_batch), "Raster Cache Writes per Transaction")
+		("raster-cache-flush", po::value(&raster_cache_flush)->value_name("ms")->default_value(raster_cache_flush), "Raster Cache Write-behind Delay")
+		("raster-cache-wal", po::bool_switch(&raster_cache_wal), "Use WAL journaling with normal syncs for the Raster Cache")
+		("ttl", po::value(&ttl)->value_name("hours")->default_value(ttl), "Time to live of rendered tiles")
+		("ttl-zoom", po::value(&ttl_zooms)->value_name("z0-z1=hours")->composing(), "Time to live of rendered tiles at zoom levels, repeatable")
+		("style-version", po::value(&style_version)->value_name("string"), "Version of the style; tiles rendered for another version are stale")
+		("program-cache-dir", po::value(&program_cache_dir)->value_name("directory"), "Directory compiled shaders are kept in across renderers and runs")
+		("log-level", po::value(&log_level)->value_name("off|requests|trace")->default_value(log_level), "Access log verbosity")
+		("vector-cache,v", po::value(&vector_cache_file)->value_name("sqlite3")->default_value(vector_cache_file), "Vector Tile Cache File")
+		("vector-cache-limit,V", po::value(&vector_cache_limit)->value_name("Mb")->default_value(vector_cache_limit), "Vector Cache Limit")
+		("asset-root,a", po::value(&asset_root)->value_name("directory")->default_value(asset_root), "Directory to which asset:// URLs will resolve")
+		("sources-map,m", po::value(&sources_map_file)->value_name("path")->default_value(sources_map_file),"Name of MbTilesSource URL Map")
+    ;
+
+    ExpirationPolicy expirationPolicy;
+    mbgl::LatLngBounds bounds = mbgl::LatLngBounds::world();
+    AccessLog::Verbosity logVerbosity;
+    try {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+        if (tile_size != 256 && tile_size != 512) {
+        	throw std::runtime_error("Tile Size must be 256 or 512");
+        }
+        if (scale < 1 || scale > TileRouter::maxScale) {
+        	throw std::runtime_error("Scale must be between 1 and 4");
+        }
+        if (style_name.empty() || style_name.find_first_of(":/") != std::string::npos) {
+        	throw std::runtime_error("Style name must not be empty or contain ':' or '/'");
+        }
+        if (metatile != 1 && metatile != 2 && metatile != 4 && metatile != 8) {
+        	throw std::runtime_error("Metatile must be 1, 2, 4 or 8");
+        }
+        const RendererKey key { style_name, tile_size, scale };
+        if (key.pixelRatio() * tile_size > max_texture_size) {
+        	throw std::runtime_error("Tiles of this size and scale don't fit the Max Texture Size");
+        }
+        // Jobs are planned by the blocks the renderers actually render.
+        metatile = key.fitMetatile(metatile, max_texture_size);
+        if (png_level < 0 || png_level > 9) {
+        	throw std::runtime_error("PNG level must be between 0 and 9");
+        }
+        if (jpeg_quality < 0 || jpeg_quality > 100 || webp_quality < 0 || webp_quality > 100) {
+        	throw std::runtime_error("Quality must be between 0 and 100");
+        }
+        if (min_zoom > max_zoom || max_zoom > ExpirationPolicy::maxZoom) {
+        	throw std::runtime_error("Invalid zoom range");
+        }
+        if (!TileEncoder::isSupported(format)) {
+        	throw std::runtime_error("Format must be png, jpg or webp");
+        }
+        if (order != "hilbert" && order != "row") {
+        	throw std::runtime_error("Order must be hilbert or row");
+        }
+        if (!bbox.empty() == !geojson_file.empty()) {
+        	throw std::runtime_error("Either --bbox or --geojson is required");
+        }
+        bounds = bbox.empty() ? parseGeoJSONBounds(geojson_file) : parseBBox(bbox);
+        expirationPolicy.setTTL(0, ExpirationPolicy::maxZoom, std::chrono::hours(ttl));
+        for (const auto& spec : ttl_zooms) {
+        	expirationPolicy.parseTTL(spec);
+        }
+        if (!style_version.empty()) {
+        	expirationPolicy.setStyleVersion(style_version);
+        }
+        logVerbosity = AccessLog::parseVerbosity(log_level);
+    } catch(std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl << desc;
+        exit(1);
+    }
+  AccessLog::get().configure(logVerbosity);
+
+  TilePath tile;
+  tile.name = style_name;
+  tile.tileSize = tile_size;
+  tile.scale = scale;
+  tile.format = format;
+  const std::vector<SeedJob> jobs = planJobs(bounds, min_zoom, max_zoom, metatile, order == "hilbert", tile);
+  std::size_t totalTiles = 0;
+  for (const auto& job : jobs) {
+	  totalTiles += job.tiles;
+  }
+
+  std::ostringstream description;
+  description << style_url << " " << bounds.west() << "," << bounds.south() << "," << bounds.east() << ","
+		  << bounds.north() << " z" << min_zoom << "-" << max_zoom << " " << tile_size << " " << metatile << " " << order << " " << format;
+  // Left out for the defaults, so progress files of earlier seeds still match.
+  if (style_name != "data" || scale != 1) {
+	  description << " " << style_name << "@" << scale << "x";
+  }
+  const std::size_t resumeAt = progress_file.empty() ? 0 :
+		  std::min(readProgress(progress_file, description.str()), jobs.size());
+  std::size_t skippedTiles = 0;
+  for (std::size_t i = 0; i < resumeAt; i++) {
+	  skippedTiles += jobs[i].tiles;
+  }
+  std::cout << "Seeding " << totalTiles << " tiles in " << jobs.size() << " renders";
+  if (resumeAt) {
+	  std::cout << ", resuming after " << skippedTiles << " tiles";
+  }
+  std::cout << std::endl;
+
+  mbgl::DefaultFileSource vectorCache(vector_cache_file, asset_root, std::size_t(vector_cache_limit) << 20);
+  SourcesSpec specs = SourcesSpec();
+  if (sources_map_file != "") {
+	  SourcesSpecLoader loader(sources_map_file);
+	  specs = loader.get();
+  }
+  SourcesFileSource sources(specs);
+  SourcesDefaultFileSource fileSource(sources, vectorCache);
+
+  TileEncoder::Options encoderOptions;
+  encoderOptions.png.level = png_level;
+  encoderOptions.png.palette = png8;
+  encoderOptions.jpegQuality = jpeg_quality;
+  encoderOptions.webpQuality = webp_quality;
+  encoderOptions.webpLossless = webp_lossless;
+
+  RenderCache rasterCache(raster_cache_file, std::size_t(raster_cache_limit) << 20,
+		  std::max(raster_cache_batch, 1u), std::chrono::milliseconds(raster_cache_flush), raster_cache_wal);
+  if (render_workers <= 0) {
+    render_workers = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (encode_workers <= 0) {
+    encode_workers = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  queue_depth = std::max(queue_depth, 1u);
+  // Declared before the render pool, so it outlives the renderers that submit to it.
+  EncodePool encodePool(encode_workers, queue_depth, encoderOptions);
+  // The first renderer to load the style shares it with the others.
+  StyleSnapshot styleSnapshot;
+  const auto programCacheDir = program_cache_dir.empty() ?
+		  mbgl::optional<std::string>() : mbgl::optional<std::string>(program_cache_dir);
+  // Every job has the same key, so each worker needs a single renderer.
+  RenderPool renderPool(render_workers, queue_depth, 1, [&] (const std::string& id, const RendererKey& key) {
+	  return std::make_unique<RasterTileRenderer>(
+			  id,
+			  style_url,
+			  key.tileSize,
+			  key.tileSize,
+			  key.pixelRatio(),
+			  0.0,
+			  0.0,
+			  rasterCache,
+			  expirationPolicy,
+			  fileSource,
+			  render_threads,
+			  metatile,
+			  encoderOptions,
+			  &encodePool,
+			  &styleSnapshot,
+			  programCacheDir);
+  }, metatile, max_texture_size);
+
+  // Jobs complete out of order; progress is the prefix of completed jobs.
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::vector<bool> completed(jobs.size(), false);
+  std::size_t prefix = resumeAt;
+  std::size_t inflight = 0;
+  std::size_t doneTiles = skippedTiles;
+  std::size_t failedTiles = 0;
+
+  const auto begin = std::chrono::steady_clock::now();
+  auto lastReport = begin;
+  std::size_t lastReportTiles = doneTiles;
+
+  auto report = [&] (std::chrono::steady_clock::time_point now) {
+	  const std::chrono::duration<double> elapsed = now - begin;
+	  const std::chrono::duration<double> interval = now - lastReport;
+	  const double rate = (doneTiles - skippedTiles) / std::max(elapsed.count(), 1e-3);
+	  const double recent = (doneTiles - lastReportTiles) / std::max(interval.count(), 1e-3);
+	  std::cout << "Seeded " << doneTiles << "/" << totalTiles << " tiles ("
+			  << (totalTiles ? 100.0 * doneTiles / totalTiles : 100.0) << "%), "
+			  << recent << " tiles/s now, " << rate << " tiles/s overall";
+	  if (rate > 0) {
+		  std::cout << ", " << static_cast<long>((totalTiles - doneTiles) / rate) << "s remaining";
+	  }
+	  if (failedTiles) {
+		  std::cout << ", " << failedTiles << " failed";
+	  }
+	  std::cout << std::endl;
+	  lastReport = now;
+	  lastReportTiles = doneTiles;
+	  if (!progress_file.empty()) {
+		  writeProgress(progress_file, description.str(), prefix);
+	  }
+  };
+
+  std::unique_lock<std::mutex> lock(mutex);
+  std::size_t next = resumeAt;
+  while (prefix < jobs.size()) {
+	  while (next < jobs.size() && inflight < queue_depth) {
+		  const std::size_t index = next;
+		  RenderJob job;
+		  job.path = jobs[index].path;
+		  // Background jobs always render, which is what --force asks for.
+		  job.background = force;
+		  job.callback = [&, index] (std::shared_ptr<const std::string> data, mbgl::optional<mbgl::Timestamp>, Metrics::Outcome) {
+			  std::lock_guard<std::mutex> guard(mutex);
+			  completed[index] = true;
+			  inflight--;
+			  doneTiles += jobs[index].tiles;
+			  if (!data) {
+				  failedTiles += jobs[index].tiles;
+			  }
+			  while (prefix < completed.size() && completed[prefix]) {
+				  prefix++;
+			  }
+			  changed.notify_one();
+		  };
+		  lock.unlock();
+		  const bool accepted = renderPool.submit(std::move(job));
+		  lock.lock();
+		  if (!accepted) {
+			  // The queue is full; wait for jobs to drain.
+			  break;
+		  }
+		  inflight++;
+		  next++;
+	  }
+
+	  const auto deadline = lastReport + std::chrono::seconds(std::max(report_interval, 1u));
+	  changed.wait_until(lock, deadline);
+	  const auto now = std::chrono::steady_clock::now();
+	  if (now >= deadline) {
+		  report(now);
+	  }
+  }
+  report(std::chrono::steady_clock::now());
+  lock.unlock();
+
+  for (const auto& stats : renderPool.getRenderStats()) {
+	  std::cout << stats.id << ": " << stats.numberOfRequests << " renders, "
+			  << stats.renderingCurrentTotalDuration.count() << "ms rendering, "
+			  << stats.encodingCurrentTotalDuration.count() << "ms encoding" << std::endl;
+  }
+  return failedTiles ? 1 : 0;
+}
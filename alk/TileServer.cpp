@@ -11,13 +11,31 @@
 #include <map>
 #include <thread>
 #include <mutex>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <regex>
+#include <functional>
+#include <future>
+#include <sstream>
 
 #include <boost/program_options.hpp>
 
+#include "AccessLog.hpp"
+#include "AssetHandler.hpp"
+#include "AssetSource.hpp"
+#include "CacheStatsHandler.hpp"
+#include "EncodePool.hpp"
+#include "ExpirationPolicy.hpp"
+#include "MetricsHandler.hpp"
+#include "PipelineStatsHandler.hpp"
+#include "ReadinessHandler.hpp"
 #include "RenderCache.hpp"
+#include "RenderPool.hpp"
+#include "StyleSnapshot.hpp"
+#include "TileEncoder.hpp"
 #include "TileHandler.hpp"
+#include "TileMemoryCache.hpp"
+#include "TileRouter.hpp"
 #include "StatsHandler.hpp"
 #include "SourcesFileSource.hpp"
 #include "SourcesDefaultFileSource.hpp"
@@ -34,32 +52,49 @@ using namespace alk;
 
 namespace po = boost::program_options;
 
-class Entry {
-public:
-	mbgl::util::RunLoop* loop;
-	RasterTileRenderer * renderer;
-};
+namespace {
+
+// Parses a comma separated list of numbers, such as 1,2.
+std::vector<uint32_t> parseList(const std::string& list) {
+	std::vector<uint32_t> values;
+	std::istringstream in(list);
+	uint32_t value;
+	char separator = ',';
+	while (separator == ',' && in >> value) {
+		values.push_back(value);
+		separator = 0;
+		in >> separator;
+	}
+	// The list must end with a number.
+	if (separator != 0 || values.empty()) {
+		throw std::runtime_error("Expected a comma separated list of numbers: " + list);
+	}
+	return values;
+}
 
-std::mutex g_gl_render_mutex;
+} // namespace
 
 class TileHandlerFactory : public RequestHandlerFactory {
  public:
 	TileHandlerFactory(std::string serverName_,
 			std::chrono::system_clock::time_point begin_,
-			std::map<std::thread::id, Entry *>& renderers_,
-			std::string styleUrl_,
-			unsigned int tileSize_,
-			RenderCache& rasterCache_,
-			mbgl::FileSource& fileSource_,
-			int renderThreads_) :
+			RenderPool& renderPool_,
+			EncodePool& encodePool_,
+			TileMemoryCache& memoryCache_,
+			std::function<bool ()> ready_,
+			AssetSource& assets_,
+			std::vector<std::string> styles_,
+			uint32_t tileSize_,
+			std::vector<uint32_t> tileSizes_,
+			std::vector<uint32_t> scales_) :
 			serverName(serverName_),
 			beginTime(begin_),
-			styleUrl(styleUrl_),
-			tileSize(tileSize_),
-		    rendererLoops(renderers_),
-			rasterCache(rasterCache_),
-			fileSource(fileSource_),
-			renderThreads(renderThreads_){}
+			renderPool(renderPool_),
+			encodePool(encodePool_),
+			memoryCache(memoryCache_),
+			ready(std::move(ready_)),
+			assets(assets_),
+			router(std::move(styles_), tileSize_, std::move(tileSizes_), std::move(scales_)) {}
   void onServerStart(folly::EventBase* /*evb*/) noexcept override {
   }
 
@@ -67,103 +102,229 @@ class TileHandlerFactory : public RequestHandlerFactory {
   }
 
   RequestHandler* onRequest(RequestHandler* h, HTTPMessage* msg) noexcept override {
-	  std::smatch base_match;
-      auto res = std::regex_search(msg->getURL(), base_match, std::regex("/stats"));
-	  if (res) {
+	  const auto route = router.match(msg->getPath(), msg->getQueryString());
+	  switch (route.endpoint) {
+	  case TileRouter::Endpoint::Metrics:
+		  return new MetricsHandler(renderPool.getStats(), encodePool.getStats(), memoryCache.getStats());
+	  case TileRouter::Endpoint::CacheStats:
+		  return new CacheStatsHandler(memoryCache.getStats());
+	  case TileRouter::Endpoint::PipelineStats:
+		  return new PipelineStatsHandler(renderPool.getStats(), renderPool.getRenderStats(), encodePool.getStats());
+	  case TileRouter::Endpoint::Stats:
 		  return onStatsRequest(h, msg);
+	  case TileRouter::Endpoint::Ready:
+		  return new ReadinessHandler(ready());
+	  case TileRouter::Endpoint::VectorTile:
+	  case TileRouter::Endpoint::Glyphs:
+	  case TileRouter::Endpoint::Sprite:
+		  return new AssetHandler(&assets, route);
+	  case TileRouter::Endpoint::Tile:
+	  case TileRouter::Endpoint::NotFound:
+		  break;
 	  }
-	  return onTileRequest(h, msg);
+	  return onTileRequest(route);
   }
 
   RequestHandler* onStatsRequest(RequestHandler *, HTTPMessage *) noexcept {
-	  std::vector<RenderStats> renderers;
-	  for(auto rl: rendererLoops) {
-		  renderers.push_back(rl.second->renderer->getRenderStats());
-	  }
-	  return new StatsHandler(serverName, beginTime, renderers);
+	  return new StatsHandler(serverName, beginTime, renderPool.getRenderStats());
   }
 
-  RequestHandler* onTileRequest(RequestHandler*, HTTPMessage*) noexcept {
-	  auto tid = std::this_thread::get_id();
-	  std::stringstream id;
-	  id << tid;
-	  std::string sid = id.str();
-	  Entry *entry = rendererLoops[tid];
-	  if (entry == NULL) {
-		  entry = new Entry();
-		  entry->loop = new mbgl::util::RunLoop(mbgl::util::RunLoop::Type::New);
-		  entry->renderer = new RasterTileRenderer(
-				  sid,
-				  styleUrl,
-				  tileSize,
-				  tileSize,
-				  tileSize < 512 ? 1.0 : 2.0, // pixelRatio
-				  0.0,
-				  0.0,
-				  rasterCache,
-				  fileSource,
-				  g_gl_render_mutex,
-				  this->renderThreads);
-		  rendererLoops[tid] = entry;
-	  }
-    return new TileHandler(entry->loop, entry->renderer);
+  RequestHandler* onTileRequest(const TileRouter::Match& route) noexcept {
+    return new TileHandler(&renderPool, &memoryCache, route);
   }
 
  private:
   std::string serverName;
   std::chrono::system_clock::time_point beginTime;
-  std::string styleUrl;
-  unsigned int tileSize;
-  std::map<std::thread::id, Entry *>& rendererLoops;
-  RenderCache& rasterCache;
-  mbgl::FileSource& fileSource;
-  int renderThreads;
+  RenderPool& renderPool;
+  EncodePool& encodePool;
+  TileMemoryCache& memoryCache;
+  const std::function<bool ()> ready;
+  AssetSource& assets;
+  const TileRouter router;
 };
 
 int main(int argc, char* argv[]) {
-	std::string style_url;
+	std::vector<std::string> style_specs;
+	std::vector<std::string> vector_source_specs;
+	std::vector<std::string> sprite_specs;
+	std::string glyphs_url;
 	unsigned int server_threads = 1;
 	unsigned int render_threads = 4;
+	unsigned int render_workers = 1;
+	unsigned int renderers_per_worker = 4;
+	unsigned int queue_depth = 256;
+	unsigned int encode_workers = 0;
+	unsigned int encode_queue_depth = 64;
 	std::string raster_cache_file = "raster.cache";
 	std::string vector_cache_file = "vector.cache";
 	std::string sources_map_file = "";
 	std::string asset_root = ".";
 	std::string serverName = "ALK Raster Render Server";
 	unsigned int raster_cache_limit = 1024;
+	unsigned int memory_cache_limit = 256;
+	unsigned int raster_cache_batch = 64;
+	unsigned int raster_cache_flush = 500;
+	bool raster_cache_wal = false;
 	unsigned int vector_cache_limit = 1024;
 	unsigned int http_port = 11000;
 	unsigned int tile_size = 512;
+	std::string tile_sizes = "256,512";
+	std::string scales = "1,2";
+	unsigned int max_texture_size = 4096;
+	int png_level = 6;
+	bool png8 = false;
+	int jpeg_quality = 85;
+	int webp_quality = 80;
+	bool webp_lossless = false;
+	unsigned int metatile = 1;
+	unsigned int ttl = 30;
+	std::vector<std::string> ttl_zooms;
+	std::string style_version;
+	std::string log_level = "requests";
+	bool stale_while_revalidate = false;
 	std::string bind_address = "0.0.0.0";
+	std::string program_cache_dir;
+	bool no_warm_up = false;
 
     po::options_description desc("Allowed options");
     desc.add_options()
     	("name,n", po::value(&serverName)->value_name("server name"), "Server Name")
-		("style,s", po::value(&style_url)->required()->value_name("url"), "Mapbox Stylesheet URL")
-		("tile-size,z", po::value(&tile_size)->value_name("integer")->default_value(512), "TileSize (256,512)")
+		("style,s", po::value(&style_specs)->required()->value_name("[name=]url")->composing(), "Mapbox Stylesheet URL, served as /name/..., repeatable. The name defaults to data")
+		("vector-source", po::value(&vector_source_specs)->value_name("name=url")->composing(), "Tile URL template of a vector source, served as /vector/name/{z}/{x}/{y}.pbf, repeatable")
+		("glyphs", po::value(&glyphs_url)->value_name("url"), "Glyphs URL template, with {fontstack} and {range}, served as /fonts/...")
+		("sprite", po::value(&sprite_specs)->value_name("[name=]url")->composing(), "Sprite base URL of a style, served as /sprites/name..., repeatable. The name defaults to data")
+		("tile-size,z", po::value(&tile_size)->value_name("integer")->default_value(512), "Default TileSize (256,512) of tiles requested without one")
+		("tile-sizes", po::value(&tile_sizes)->value_name("list")->default_value(tile_sizes), "TileSizes (256,512) served besides the default one")
+		("scales", po::value(&scales)->value_name("list")->default_value(scales), "Pixel densities (1-4) served as @{scale}x besides 1")
+		("max-texture-size", po::value(&max_texture_size)->value_name("pixels")->default_value(max_texture_size), "Largest framebuffer the GL renderers may use. Metatiles are made smaller to fit it")
+		("metatile,M", po::value(&metatile)->value_name("integer")->default_value(metatile), "Metatile size (1,2,4,8). Renders NxN tiles per pass")
+		("png-level", po::value(&png_level)->value_name("integer")->default_value(png_level), "PNG deflate level, from 0 (fastest) to 9 (smallest)")
+		("png8", po::bool_switch(&png8), "Quantize tiles to 8-bit palette PNGs")
+		("jpeg-quality", po::value(&jpeg_quality)->value_name("integer")->default_value(jpeg_quality), "JPEG quality, from 0 to 100")
+		("webp-quality", po::value(&webp_quality)->value_name("integer")->default_value(webp_quality), "WebP quality, from 0 to 100")
+		("webp-lossless", po::bool_switch(&webp_lossless), "Encode WebP tiles losslessly")
 		("port,p", po::value(&http_port)->value_name("integer")->default_value(http_port), "Http Port")
 		("bind,b", po::value(&bind_address)->value_name("IP Address")->default_value(bind_address), "IP Address to which to bind server.")
 		("server-threads,t", po::value(&server_threads)->value_name("integer")->default_value(server_threads), "Number of Server Threads")
-		("render-threads,T", po::value(&render_threads)->value_name("integer")->default_value(render_threads), "Number of Render Threads per Server Thread")
+		("render-workers,w", po::value(&render_workers)->value_name("integer")->default_value(render_workers), "Number of Render Workers (GL contexts)")
+		("renderers-per-worker", po::value(&renderers_per_worker)->value_name("integer")->default_value(renderers_per_worker), "Renderers (style, size and scale combinations) kept alive per Render Worker")
+		("render-threads,T", po::value(&render_threads)->value_name("integer")->default_value(render_threads), "Number of Render Threads per Render Worker")
+		("queue-depth,q", po::value(&queue_depth)->value_name("integer")->default_value(queue_depth), "Maximum queued tile jobs before responding 503")
+		("encode-workers", po::value(&encode_workers)->value_name("integer")->default_value(encode_workers), "Number of Tile Encoding Threads (0 = number of CPUs)")
+		("encode-queue-depth", po::value(&encode_queue_depth)->value_name("integer")->default_value(encode_queue_depth), "Maximum rendered tiles waiting to be encoded before render workers encode them")
 		("raster-cache,r", po::value(&raster_cache_file)->value_name("sqlite3")->default_value(raster_cache_file), "Raster Tile Cache File")
 		("raster-cache-limit,R", po::value(&raster_cache_limit)->value_name("Mb")->default_value(raster_cache_limit), "Raster Cache Limit")
+		("raster-cache-batch", po::value(&raster_cache_batch)->value_name("integer")->default_value(raster_cache_batch), "Raster Cache Writes per Transaction")
+		("raster-cache-flush", po::value(&raster_cache_flush)->value_name("ms")->default_value(raster_cache_flush), "Raster Cache Write-behind Delay")
+		("raster-cache-wal", po::bool_switch(&raster_cache_wal), "Use WAL journaling with normal syncs for the Raster Cache")
+		("ttl", po::value(&ttl)->value_name("hours")->default_value(ttl), "Time to live of rendered tiles")
+		("ttl-zoom", po::value(&ttl_zooms)->value_name("z0-z1=hours")->composing(), "Time to live of rendered tiles at zoom levels, repeatable")
+		("style-version", po::value(&style_version)->value_name("string"), "Version of the style; tiles rendered for another version are stale")
+		("log-level", po::value(&log_level)->value_name("off|requests|trace")->default_value(log_level), "Access log verbosity")
+		("program-cache-dir", po::value(&program_cache_dir)->value_name("directory"), "Directory compiled shaders are kept in across renderers and restarts")
+		("no-warm-up", po::bool_switch(&no_warm_up), "Create renderers on their first request instead of at startup")
+		("stale-while-revalidate", po::bool_switch(&stale_while_revalidate), "Serve stale tiles while re-rendering them in the background")
+		("memory-cache-limit,C", po::value(&memory_cache_limit)->value_name("Mb")->default_value(memory_cache_limit), "In-memory Rendered Tile Cache Limit (0 disables)")
 		("vector-cache,v", po::value(&vector_cache_file)->value_name("sqlite3")->default_value(vector_cache_file), "Vector Tile Cache File")
 		("vector-cache-limit,V", po::value(&vector_cache_limit)->value_name("Mb")->default_value(vector_cache_limit), "Vector Cache Limit")
 		("asset-root,a", po::value(&asset_root)->value_name("directory")->default_value(asset_root), "Directory to which asset:// URLs will resolve")
 		("sources-map,m", po::value(&sources_map_file)->value_name("path")->default_value(sources_map_file),"Name of MbTilesSource URL Map")
     ;
 
+    ExpirationPolicy expirationPolicy;
+    AccessLog::Verbosity logVerbosity;
+    // Style names, in the order the router knows them, and their urls.
+    std::vector<std::string> style_names;
+    std::vector<std::string> style_urls;
+    std::vector<uint32_t> tile_size_list;
+    std::vector<uint32_t> scale_list;
+    AssetSource::Options assetOptions;
     try {
         po::variables_map vm;
         po::store(po::parse_command_line(argc, argv, desc), vm);
         po::notify(vm);
+        for (const auto& spec : style_specs) {
+        	const auto equals = spec.find('=');
+        	// Anything that looks like a url is unnamed; names can't contain ':' or '/'.
+        	const bool named = equals != std::string::npos && spec.find_first_of(":/") > equals;
+        	const std::string name = named ? spec.substr(0, equals) : "data";
+        	if (name.empty() || std::find(style_names.begin(), style_names.end(), name) != style_names.end()) {
+        		throw std::runtime_error("Style names must be unique and not empty: " + spec);
+        	}
+        	if (name == "vector" || name == "fonts" || name == "sprites" || name == "stats" || name == "metrics" || name == "ready") {
+        		throw std::runtime_error("Style name is reserved: " + name);
+        	}
+        	std::string url = named ? spec.substr(equals + 1) : spec;
+        	if (url.find("://") == std::string::npos) {
+        		url = "file://" + url;
+        	}
+        	style_names.push_back(name);
+        	style_urls.push_back(url);
+        }
+        for (const auto& spec : vector_source_specs) {
+        	const auto equals = spec.find('=');
+        	if (equals == 0 || equals == std::string::npos ||
+        			!assetOptions.vectorSources.emplace(spec.substr(0, equals), spec.substr(equals + 1)).second) {
+        		throw std::runtime_error("Vector sources must be name=url with unique names: " + spec);
+        	}
+        }
+        for (const auto& spec : sprite_specs) {
+        	const auto equals = spec.find('=');
+        	const bool named = equals != std::string::npos && spec.find_first_of(":/") > equals;
+        	const std::string name = named ? spec.substr(0, equals) : "data";
+        	if (name.empty() || !assetOptions.sprites.emplace(name, named ? spec.substr(equals + 1) : spec).second) {
+        		throw std::runtime_error("Sprite names must be unique and not empty: " + spec);
+        	}
+        }
+        assetOptions.glyphs = glyphs_url;
         if (tile_size != 256 && tile_size != 512) {
         	throw std::runtime_error("Tile Size must be 256 or 512");
         }
+        if (metatile != 1 && metatile != 2 && metatile != 4 && metatile != 8) {
+        	throw std::runtime_error("Metatile must be 1, 2, 4 or 8");
+        }
+        tile_size_list = parseList(tile_sizes);
+        scale_list = parseList(scales);
+        // Tiles of the default size and at 1x are always served.
+        tile_size_list.push_back(tile_size);
+        scale_list.push_back(1);
+        for (uint32_t size : tile_size_list) {
+        	if (size != 256 && size != 512) {
+        		throw std::runtime_error("Tile Sizes must be 256 or 512");
+        	}
+        	for (uint32_t scale : scale_list) {
+        		if (scale < 1 || scale > TileRouter::maxScale) {
+        			throw std::runtime_error("Scales must be between 1 and 4");
+        		}
+        		// A single tile of every size and scale served must fit.
+        		if (RendererKey{ "", size, scale }.pixelRatio() * size > max_texture_size) {
+        			throw std::runtime_error("Tiles of size " + std::to_string(size) + " at scale " +
+        					std::to_string(scale) + " don't fit the Max Texture Size");
+        		}
+        	}
+        }
+        if (png_level < 0 || png_level > 9) {
+        	throw std::runtime_error("PNG level must be between 0 and 9");
+        }
+        if (jpeg_quality < 0 || jpeg_quality > 100 || webp_quality < 0 || webp_quality > 100) {
+        	throw std::runtime_error("Quality must be between 0 and 100");
+        }
+        expirationPolicy.setTTL(0, ExpirationPolicy::maxZoom, std::chrono::hours(ttl));
+        for (const auto& spec : ttl_zooms) {
+        	expirationPolicy.parseTTL(spec);
+        }
+        if (!style_version.empty()) {
+        	expirationPolicy.setStyleVersion(style_version);
+        }
+        expirationPolicy.setStaleWhileRevalidate(stale_while_revalidate);
+        logVerbosity = AccessLog::parseVerbosity(log_level);
     } catch(std::exception& e) {
         std::cout << "Error: " << e.what() << std::endl << desc;
         exit(1);
     }
-  mbgl::DefaultFileSource vectorCache(vector_cache_file, asset_root, vector_cache_limit * 1024*1024);
+  AccessLog::get().configure(logVerbosity);
+  mbgl::DefaultFileSource vectorCache(vector_cache_file, asset_root, std::size_t(vector_cache_limit) << 20);
   SourcesSpec specs = SourcesSpec();
   if (sources_map_file != "") {
 	  SourcesSpecLoader loader(sources_map_file);
@@ -171,9 +332,72 @@ int main(int argc, char* argv[]) {
   }
   SourcesFileSource sources(specs);
   SourcesDefaultFileSource fileSource(sources, vectorCache);
+  // Declared before the asset source, which may still answer the style fetches below.
+  StyleSnapshot styleSnapshot;
+  // Vector tiles, glyphs and sprites are served from the renderers' file source.
+  AssetSource assets(fileSource, std::move(assetOptions));
+
+  const auto programCacheDir = program_cache_dir.empty() ?
+		  mbgl::optional<std::string>() : mbgl::optional<std::string>(program_cache_dir);
 
-  RenderCache rasterCache(raster_cache_file, raster_cache_limit * 1024*1024);
-  std::map<std::thread::id, Entry *> renderers;
+  TileEncoder::Options encoderOptions;
+  encoderOptions.png.level = png_level;
+  encoderOptions.png.palette = png8;
+  encoderOptions.jpegQuality = jpeg_quality;
+  encoderOptions.webpQuality = webp_quality;
+  encoderOptions.webpLossless = webp_lossless;
+
+  RenderCache rasterCache(raster_cache_file, std::size_t(raster_cache_limit) << 20,
+		  std::max(raster_cache_batch, 1u), std::chrono::milliseconds(raster_cache_flush), raster_cache_wal);
+  TileMemoryCache memoryCache(std::size_t(memory_cache_limit) << 20);
+  if (encode_workers <= 0) {
+    encode_workers = sysconf(_SC_NPROCESSORS_ONLN);
+    CHECK(encode_workers > 0);
+  }
+  // Declared before the render pool, so it outlives the renderers that submit to it.
+  EncodePool encodePool(encode_workers, encode_queue_depth, encoderOptions);
+  if (render_workers <= 0) {
+    render_workers = sysconf(_SC_NPROCESSORS_ONLN);
+    CHECK(render_workers > 0);
+  }
+  // All renderers share the file source, and thus the vector tiles, glyphs
+  // and sprites in the vector cache.
+  RenderPool renderPool(render_workers, queue_depth, renderers_per_worker,
+		  [&] (const std::string& id, const RendererKey& key) -> std::unique_ptr<RasterTileRenderer> {
+	  const auto style = std::find(style_names.begin(), style_names.end(), key.style);
+	  if (style == style_names.end()) {
+		  return nullptr;
+	  }
+	  return std::make_unique<RasterTileRenderer>(
+			  id,
+			  style_urls[style - style_names.begin()],
+			  key.tileSize,
+			  key.tileSize,
+			  key.pixelRatio(),
+			  0.0,
+			  0.0,
+			  rasterCache,
+			  expirationPolicy,
+			  fileSource,
+			  render_threads,
+			  key.fitMetatile(metatile, max_texture_size),
+			  encoderOptions,
+			  &encodePool,
+			  &styleSnapshot,
+			  programCacheDir);
+  }, metatile, max_texture_size);
+  // Set once the style fetches are done and the workers were told to warm up.
+  std::atomic<bool> started { false };
+  // /ready answers 503 until every style is loaded and the workers are warm.
+  auto ready = [&] () {
+	  if (!started || !renderPool.ready()) {
+		  return false;
+	  }
+	  // Renderers put the styles they fetched themselves in the snapshot too.
+	  return std::all_of(style_urls.begin(), style_urls.end(), [&] (const std::string& url) {
+		  return styleSnapshot.get(url) != nullptr;
+	  });
+  };
   std::vector<HTTPServer::IPConfig> IPs = {
     {SocketAddress(bind_address, http_port, true), Protocol::HTTP}
   };
@@ -191,18 +415,49 @@ int main(int argc, char* argv[]) {
   std::chrono::system_clock::time_point begin =
 			std::chrono::system_clock::now();
   options.handlerFactories = RequestHandlerChain()
-      .addThen<TileHandlerFactory>(serverName, begin, renderers, style_url, tile_size, rasterCache, fileSource, render_threads)
+      .addThen<TileHandlerFactory>(serverName, begin, renderPool, encodePool, memoryCache, ready, assets, style_names, tile_size,
+    		  tile_size_list, scale_list)
       .build();
   options.h2cEnabled = true;
 
   HTTPServer server(std::move(options));
   server.bind(IPs);
 
+  // Fetch every style at once, so renderers load it from memory.
+  std::vector<std::future<void>> styles;
+  for (const auto& url : style_urls) {
+	  auto loaded = std::make_shared<std::promise<void>>();
+	  styles.push_back(loaded->get_future());
+	  assets.fetch(mbgl::Resource::style(url), [&styleSnapshot, url, loaded] (mbgl::Response response) {
+		  if (response.data && !response.error) {
+			  styleSnapshot.put(url, *response.data);
+		  }
+		  loaded->set_value();
+	  });
+  }
+  // Workers warm up once the styles are in, while the server already
+  // answers. Renderers fetch the styles that don't come in time themselves.
+  std::thread warmUp([&] () {
+	  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+	  for (auto& style : styles) {
+		  style.wait_until(deadline);
+	  }
+	  if (!no_warm_up) {
+		  std::vector<RendererKey> keys;
+		  for (const auto& name : style_names) {
+			  keys.push_back({ name, tile_size, 1 });
+		  }
+		  renderPool.warmUp(keys);
+	  }
+	  started = true;
+  });
+
   // Start HTTPServer mainloop in a separate thread
   std::thread t([&] () {
 	  server.start();
   });
 
   t.join();
+  warmUp.join();
   return 0;
 }
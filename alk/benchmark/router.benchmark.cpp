@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+
+#include "TileRouter.hpp"
+
+#include <regex>
+#include <string>
+
+using namespace alk;
+
+namespace {
+
+const std::string path = "/data/14/8185/5449@2x.webp";
+const std::string queryPath = "/data";
+const std::string query = "x=8185&y=5449&z=14";
+
+} // namespace
+
+static void Router_Path(::benchmark::State& state) {
+    const TileRouter router;
+    while (state.KeepRunning()) {
+        ::benchmark::DoNotOptimize(router.match(path, ""));
+    }
+}
+
+static void Router_Query(::benchmark::State& state) {
+    const TileRouter router;
+    while (state.KeepRunning()) {
+        ::benchmark::DoNotOptimize(router.match(queryPath, query));
+    }
+}
+
+static void Router_NamedStyles(::benchmark::State& state) {
+    const TileRouter router({ "streets", "satellite", "terrain", "data" });
+    while (state.KeepRunning()) {
+        ::benchmark::DoNotOptimize(router.match(path, ""));
+    }
+}
+
+// What TileHandler used to do for every request: build the regex, then match.
+static void Router_RegexPath(::benchmark::State& state) {
+    while (state.KeepRunning()) {
+        std::smatch m;
+        std::regex pathMatch("/([^/]*)/([0-9]+)/([0-9]+)/([0-9]+)(@([0-9])x)?(.(png|jpg|jpeg|webp|pbf))?");
+        ::benchmark::DoNotOptimize(std::regex_match(path, m, pathMatch));
+    }
+}
+
+static void Router_RegexQuery(::benchmark::State& state) {
+    while (state.KeepRunning()) {
+        std::smatch m;
+        ::benchmark::DoNotOptimize(std::regex_search(query, m, std::regex("x=([0-9]+)")));
+        ::benchmark::DoNotOptimize(std::regex_search(query, m, std::regex("y=([0-9]+)")));
+        ::benchmark::DoNotOptimize(std::regex_search(query, m, std::regex("z=([0-9]+)")));
+    }
+}
+
+BENCHMARK(Router_Path);
+BENCHMARK(Router_Query);
+BENCHMARK(Router_NamedStyles);
+BENCHMARK(Router_RegexPath);
+BENCHMARK(Router_RegexQuery);
@@ -0,0 +1,85 @@
+#include <mbgl/test/stub_file_source.hpp>
+
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+#include <gtest/gtest.h>
+
+#include "ExpirationPolicy.hpp"
+#include "RasterTileRenderer.hpp"
+#include "RenderCache.hpp"
+#include "TilePath.hpp"
+
+using namespace mbgl;
+using namespace alk;
+
+TEST(RasterTileRenderer, FailingSource) {
+    util::RunLoop loop;
+
+    StubFileSource fileSource;
+    fileSource.styleResponse = [] (const Resource&) {
+        Response response;
+        response.data = std::make_shared<std::string>(R"STYLE({
+            "version": 8,
+            "sources": {
+                "streets": { "type": "vector", "tiles": [ "http://example.com/{z}/{x}/{y}.pbf" ] }
+            },
+            "layers": [
+                { "id": "water", "type": "fill", "source": "streets", "source-layer": "water" }
+            ]
+        })STYLE");
+        return response;
+    };
+    fileSource.tileResponse = [] (const Resource&) {
+        Response response;
+        response.error = std::make_unique<Response::Error>(Response::Error::Reason::Server, "Failed");
+        return response;
+    };
+
+    RenderCache renderCache(":memory:", 1 << 20);
+    ExpirationPolicy policy;
+    RasterTileRenderer renderer("test", "http://example.com/style.json", 256, 256, 1.0, 0.0, 0.0,
+            renderCache, policy, fileSource, 1);
+
+    TilePath path;
+    path.name = "data";
+    path.tileSize = 256;
+    path.zoom = 2;
+    path.x = 1;
+    path.y = 1;
+    path.format = "png";
+
+    bool called = false;
+    bool released = false;
+    renderer.renderTile(&path, [&] {
+        // The renderer is released after the job is answered.
+        EXPECT_TRUE(called);
+        released = true;
+        loop.stop();
+    }, [&] (std::shared_ptr<const std::string> data, RasterTileRenderer::Neighbours neighbours) {
+        EXPECT_FALSE(data);
+        EXPECT_TRUE(neighbours.empty());
+        called = true;
+    });
+
+    loop.run();
+
+    EXPECT_TRUE(called);
+    EXPECT_TRUE(released);
+
+    // The renderer takes another tile after a failed render.
+    called = false;
+    released = false;
+    renderer.renderTile(&path, [&] {
+        released = true;
+        loop.stop();
+    }, [&] (std::shared_ptr<const std::string>, RasterTileRenderer::Neighbours) {
+        called = true;
+    });
+
+    loop.run();
+
+    EXPECT_TRUE(called);
+    EXPECT_TRUE(released);
+}
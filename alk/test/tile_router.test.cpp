@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include "TileRouter.hpp"
+
+#include <string>
+
+using namespace alk;
+
+using Endpoint = TileRouter::Endpoint;
+using Format = TileRouter::Format;
+
+TEST(TileRouter, Endpoints) {
+    const TileRouter router;
+    EXPECT_EQ(Endpoint::Stats, router.match("/stats", "").endpoint);
+    EXPECT_EQ(Endpoint::CacheStats, router.match("/stats/cache", "").endpoint);
+    EXPECT_EQ(Endpoint::PipelineStats, router.match("/stats/pipeline", "").endpoint);
+    EXPECT_EQ(Endpoint::Metrics, router.match("/metrics", "").endpoint);
+    EXPECT_EQ(Endpoint::Ready, router.match("/ready", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("", "").endpoint);
+}
+
+TEST(TileRouter, Path) {
+    const TileRouter router({ "streets", "data" }, 512);
+
+    // Matches point into the path, which must outlive them.
+    const std::string path = "/data/14/8185/5449@2x.webp";
+    auto match = router.match(path, "");
+    EXPECT_EQ(Endpoint::Tile, match.endpoint);
+    EXPECT_EQ("data", match.styleName());
+    EXPECT_EQ(1u, match.styleIndex);
+    EXPECT_EQ(512u, match.tileSize);
+    EXPECT_EQ(14u, match.zoom);
+    EXPECT_EQ(8185u, match.x);
+    EXPECT_EQ(5449u, match.y);
+    EXPECT_EQ(2u, match.scale);
+    EXPECT_EQ(Format::WebP, match.format);
+
+    const std::string sizedPath = "/streets/256/0/0/0";
+    match = router.match(sizedPath, "");
+    EXPECT_EQ(Endpoint::Tile, match.endpoint);
+    EXPECT_EQ(0u, match.styleIndex);
+    EXPECT_EQ(256u, match.tileSize);
+    EXPECT_EQ(1u, match.scale);
+    EXPECT_EQ(Format::PNG, match.format);
+
+    EXPECT_EQ(Format::JPEG, router.match("/data/1/1/1.jpg", "").format);
+    EXPECT_EQ(Format::JPEG, router.match("/data/1/1/1.jpeg", "").format);
+    EXPECT_EQ(Format::PNG, router.match("/data/1/1/1@1x.png", "").format);
+    EXPECT_EQ(Format::PBF, router.match("/data/1/1/1.pbf", "").format);
+
+    // Only the router's styles are matched.
+    EXPECT_EQ(Endpoint::NotFound, router.match("/satellite/1/1/1.png", "").endpoint);
+    // Without styles, any name is.
+    EXPECT_EQ(Endpoint::Tile, TileRouter().match("/satellite/1/1/1.png", "").endpoint);
+}
+
+TEST(TileRouter, Query) {
+    const TileRouter router({ "data" }, 256);
+
+    const std::string path = "/data";
+    const auto match = router.match(path, "x=3&y=5&z=4&token=abc");
+    EXPECT_EQ(Endpoint::Tile, match.endpoint);
+    EXPECT_EQ("data", match.styleName());
+    EXPECT_EQ(256u, match.tileSize);
+    EXPECT_EQ(4u, match.zoom);
+    EXPECT_EQ(3u, match.x);
+    EXPECT_EQ(5u, match.y);
+    EXPECT_EQ(1u, match.scale);
+    EXPECT_EQ(Format::PNG, match.format);
+
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data", "x=3&y=5").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data", "x=3&y=5&z=a").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data", "x=16&y=5&z=4").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/other", "x=3&y=5&z=4").endpoint);
+}
+
+TEST(TileRouter, SizesAndScales) {
+    const TileRouter router({ "data" }, 512, { 256 }, { 2 });
+
+    EXPECT_EQ(Endpoint::Tile, router.match("/data/256/1/1/1@2x.png", "").endpoint);
+    // The default size and 1x are always served.
+    EXPECT_EQ(Endpoint::Tile, router.match("/data/512/1/1/1@1x.png", "").endpoint);
+
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1024/1/1/1.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/1/1@3x.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/1/1@0x.png", "").endpoint);
+
+    const TileRouter strict({ "data" }, 512, {}, {});
+    EXPECT_EQ(Endpoint::NotFound, strict.match("/data/256/1/1/1.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, strict.match("/data/1/1/1@2x.png", "").endpoint);
+}
+
+TEST(TileRouter, OutOfRange) {
+    const TileRouter router;
+
+    EXPECT_EQ(Endpoint::Tile, router.match("/data/30/1073741823/1073741823.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/31/0/0.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/2/4/0.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/2/0/4.png", "").endpoint);
+
+    // Numbers may have up to 18 digits.
+    EXPECT_EQ(Endpoint::Tile, router.match("/data/1/000000000000000001/0.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/0000000000000000001/0.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data", "x=0&y=0&z=0000000000000000001").endpoint);
+}
+
+TEST(TileRouter, Malformed) {
+    const TileRouter router;
+
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/1", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/1/1/1/1", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/1/1/", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/1/1.png?", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/1/1.pngx", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/1/1.gif", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/1/1x", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/1/1@2", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/1/1@2.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/1/1@x.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/data/1/a/1.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("//1/1/1.png", "").endpoint);
+}
+
+TEST(TileRouter, VectorTile) {
+    const TileRouter router({ "data" });
+
+    // Vector sources aren't checked against the styles.
+    const std::string path = "/vector/openmaptiles/3/2/1.pbf";
+    const auto match = router.match(path, "");
+    EXPECT_EQ(Endpoint::VectorTile, match.endpoint);
+    EXPECT_EQ("openmaptiles", match.styleName());
+    EXPECT_EQ(3u, match.zoom);
+    EXPECT_EQ(2u, match.x);
+    EXPECT_EQ(1u, match.y);
+    EXPECT_EQ(Format::PBF, match.format);
+
+    EXPECT_EQ(Endpoint::NotFound, router.match("/vector/openmaptiles/3/2/1.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/vector/openmaptiles/3/8/1.pbf", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/vector/openmaptiles/3/2.pbf", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/vector//3/2/1.pbf", "").endpoint);
+}
+
+TEST(TileRouter, Glyphs) {
+    const TileRouter router;
+
+    const std::string path = "/fonts/Open%20Sans%20Regular/256-511.pbf";
+    const auto match = router.match(path, "");
+    EXPECT_EQ(Endpoint::Glyphs, match.endpoint);
+    EXPECT_EQ("Open%20Sans%20Regular", match.styleName());
+    EXPECT_EQ(256u, match.glyphs);
+    EXPECT_EQ(Format::PBF, match.format);
+
+    EXPECT_EQ(Endpoint::Glyphs, router.match("/fonts/Noto/0-255.pbf", "").endpoint);
+    EXPECT_EQ(Endpoint::Glyphs, router.match("/fonts/Noto/65280-65535.pbf", "").endpoint);
+
+    // Ranges are whole, aligned blocks of 256 code points.
+    EXPECT_EQ(Endpoint::NotFound, router.match("/fonts/Noto/1-256.pbf", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/fonts/Noto/0-511.pbf", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/fonts/Noto/65536-65791.pbf", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/fonts/Noto/0-255.json", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/fonts/Noto/0255.pbf", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/fonts//0-255.pbf", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/fonts/Noto", "").endpoint);
+}
+
+TEST(TileRouter, Sprite) {
+    const TileRouter router;
+
+    const std::string path = "/sprites/streets.json";
+    auto match = router.match(path, "");
+    EXPECT_EQ(Endpoint::Sprite, match.endpoint);
+    EXPECT_EQ("streets", match.styleName());
+    EXPECT_EQ(1u, match.scale);
+    EXPECT_EQ(Format::JSON, match.format);
+
+    const std::string retinaPath = "/sprites/streets@2x.png";
+    match = router.match(retinaPath, "");
+    EXPECT_EQ(Endpoint::Sprite, match.endpoint);
+    EXPECT_EQ(2u, match.scale);
+    EXPECT_EQ(Format::PNG, match.format);
+
+    EXPECT_EQ(Endpoint::NotFound, router.match("/sprites/streets@3x.png", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/sprites/streets.pbf", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/sprites/streets", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/sprites/.json", "").endpoint);
+    EXPECT_EQ(Endpoint::NotFound, router.match("/sprites/a/b.json", "").endpoint);
+}
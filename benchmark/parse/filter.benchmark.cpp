@@ -1,6 +1,7 @@
 #include <benchmark/benchmark.h>
 
 #include <mbgl/style/filter.hpp>
+#include <mbgl/style/compiled_filter.hpp>
 #include <mbgl/style/filter_evaluator.hpp>
 #include <mbgl/style/conversion.hpp>
 #include <mbgl/style/conversion/json.hpp>
@@ -20,19 +21,65 @@ static void Parse_Filter(benchmark::State& state) {
     }
 }
 
+static optional<Value> getValue(const PropertyMap& properties, const std::string& key) {
+    auto it = properties.find(key);
+    if (it == properties.end())
+        return {};
+    return it->second;
+}
+
+// A layer filter in the style of those of the streets style: a class match
+// against many values, a type check, and a key that is looked up twice.
+const char* const layerFilter = R"FILTER(["all",
+    ["==", "$type", "Point"],
+    ["in", "maki", "airport", "bakery", "bank", "bar", "cafe", "cinema", "college", "dentist",
+        "doctor", "embassy", "fuel", "hospital", "library", "museum", "park", "pharmacy",
+        "police", "post", "restaurant", "school", "shop", "theatre", "zoo"],
+    [">=", "scalerank", 2],
+    ["<=", "scalerank", 4]])FILTER";
+
+const PropertyMap layerProperties = {
+    { "maki", std::string("restaurant") },
+    { "scalerank", uint64_t(3) },
+    { "name", std::string("Joe's") }
+};
+
 static void Parse_EvaluateFilter(benchmark::State& state) {
     const style::Filter filter = parse(R"FILTER(["==", "foo", "bar"])FILTER");
     const PropertyMap properties = { { "foo", std::string("bar") } };
 
     while (state.KeepRunning()) {
-        filter(FeatureType::Unknown, {}, [&] (const std::string& key) -> optional<Value> {
-            auto it = properties.find(key);
-            if (it == properties.end())
-                return {};
-            return it->second;
-        });
+        filter(FeatureType::Unknown, {}, [&] (const std::string& key) { return getValue(properties, key); });
+    }
+}
+
+static void Parse_EvaluateCompiledFilter(benchmark::State& state) {
+    const style::CompiledFilter filter(parse(R"FILTER(["==", "foo", "bar"])FILTER"));
+    const PropertyMap properties = { { "foo", std::string("bar") } };
+
+    while (state.KeepRunning()) {
+        filter(FeatureType::Unknown, {}, [&] (const std::string& key) { return getValue(properties, key); });
+    }
+}
+
+static void Parse_EvaluateLayerFilter(benchmark::State& state) {
+    const style::Filter filter = parse(layerFilter);
+
+    while (state.KeepRunning()) {
+        filter(FeatureType::Point, {}, [&] (const std::string& key) { return getValue(layerProperties, key); });
+    }
+}
+
+static void Parse_EvaluateCompiledLayerFilter(benchmark::State& state) {
+    const style::CompiledFilter filter(parse(layerFilter));
+
+    while (state.KeepRunning()) {
+        filter(FeatureType::Point, {}, [&] (const std::string& key) { return getValue(layerProperties, key); });
     }
 }
 
 BENCHMARK(Parse_Filter);
 BENCHMARK(Parse_EvaluateFilter);
+BENCHMARK(Parse_EvaluateCompiledFilter);
+BENCHMARK(Parse_EvaluateLayerFilter);
+BENCHMARK(Parse_EvaluateCompiledLayerFilter);
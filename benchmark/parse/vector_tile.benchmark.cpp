@@ -1,5 +1,10 @@
 #include <benchmark/benchmark.h>
 
+#include <mbgl/style/filter.hpp>
+#include <mbgl/style/filter_evaluator.hpp>
+#include <mbgl/style/conversion.hpp>
+#include <mbgl/style/conversion/json.hpp>
+#include <mbgl/style/conversion/filter.hpp>
 #include <mbgl/tile/vector_tile_data.hpp>
 #include <mbgl/util/io.hpp>
 
@@ -25,4 +30,47 @@ static void Parse_VectorTile(benchmark::State& state) {
     }
 }
 
+// Filters the POI layer the way GeometryTileWorker does, looking keys up by name.
+static void Parse_VectorTileFilter(benchmark::State& state) {
+    auto data = std::make_shared<std::string>(util::read_file("test/fixtures/api/assets/streets/10-163-395.vector.pbf"));
+    style::conversion::Error error;
+    const style::Filter filter = *style::conversion::convertJSON<style::Filter>(
+        R"FILTER(["all", ["==", "maki", "restaurant"], ["<=", "scalerank", 3]])FILTER", error);
+
+    while (state.KeepRunning()) {
+        std::size_t matched = 0;
+        VectorTileData tile(data);
+        auto layer = tile.getLayer("poi_label");
+        const std::size_t count = layer->featureCount();
+        for (std::size_t i = 0; i < count; i++) {
+            auto feature = layer->getFeature(i);
+            matched += filter(feature->getType(), feature->getID(), [&] (const auto& key) { return feature->getValue(key); });
+        }
+        benchmark::DoNotOptimize(matched);
+    }
+}
+
+// Same as above, with the keys resolved to IDs once for the layer.
+static void Parse_VectorTileFilterByKeyID(benchmark::State& state) {
+    auto data = std::make_shared<std::string>(util::read_file("test/fixtures/api/assets/streets/10-163-395.vector.pbf"));
+    style::conversion::Error error;
+    const style::Filter filter = *style::conversion::convertJSON<style::Filter>(
+        R"FILTER(["all", ["==", "maki", "restaurant"], ["<=", "scalerank", 3]])FILTER", error);
+
+    while (state.KeepRunning()) {
+        std::size_t matched = 0;
+        VectorTileData tile(data);
+        auto layer = tile.getLayer("poi_label");
+        GeometryTileLayerKeys keys(*layer);
+        const std::size_t count = layer->featureCount();
+        for (std::size_t i = 0; i < count; i++) {
+            auto feature = layer->getFeature(i);
+            matched += filter(feature->getType(), feature->getID(), [&] (const auto& key) { return keys.getValue(*feature, key); });
+        }
+        benchmark::DoNotOptimize(matched);
+    }
+}
+
 BENCHMARK(Parse_VectorTile);
+BENCHMARK(Parse_VectorTileFilter);
+BENCHMARK(Parse_VectorTileFilterByKeyID);
@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/storage/offline_database.hpp>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+
+#include <random>
+
+using namespace mbgl;
+
+namespace {
+
+// A PNG signature followed by incompressible bytes, standing in for a rendered tile.
+std::shared_ptr<std::string> pngTile() {
+    std::mt19937 generator;
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::string data = "\x89PNG\r\n\x1a\n";
+    for (std::size_t i = 0; i < 20 * 1024; ++i) {
+        data.push_back(static_cast<char>(distribution(generator)));
+    }
+    return std::make_shared<std::string>(std::move(data));
+}
+
+void putTiles(::benchmark::State& state, OfflineDatabase::CompressionPolicy policy) {
+    OfflineDatabase db(":memory:");
+    db.setCompressionPolicy(Resource::Tile, policy);
+
+    Response response;
+    response.data = pngTile();
+
+    int32_t x = 0;
+    while (state.KeepRunning()) {
+        Resource resource = Resource::tile("http://example.com/{z}/{x}/{y}.png", 1, x++, 0, 20,
+                                           Tileset::Scheme::XYZ);
+        db.put(resource, response);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * response.data->size());
+}
+
+} // namespace
+
+static void Storage_OfflineDatabase_PutPNG_Always(::benchmark::State& state) {
+    putTiles(state, OfflineDatabase::CompressionPolicy::Always);
+}
+
+static void Storage_OfflineDatabase_PutPNG_Auto(::benchmark::State& state) {
+    putTiles(state, OfflineDatabase::CompressionPolicy::Auto);
+}
+
+BENCHMARK(Storage_OfflineDatabase_PutPNG_Always);
+BENCHMARK(Storage_OfflineDatabase_PutPNG_Auto);
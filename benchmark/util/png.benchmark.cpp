@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/util/image.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/png_encoder.hpp>
+
+#include <string>
+
+using namespace mbgl;
+
+namespace {
+
+// Encodes a rendered tile with the given options. The label shows the size of
+// the encoded tile, so speed and size can be compared across options.
+void encode(::benchmark::State& state, PNGEncoder::Options options) {
+    const PremultipliedImage image = decodeImage(util::read_file("test/fixtures/map/offline/expected.png"));
+    PNGEncoder encoder(options);
+    std::size_t size = 0;
+
+    while (state.KeepRunning()) {
+        size = encoder.encode(image).size();
+    }
+
+    state.SetBytesProcessed(state.iterations() * image.bytes());
+    state.SetLabel((std::to_string(size) + " bytes").c_str());
+}
+
+PNGEncoder::Options options(int level, PNGEncoder::Filter filter, bool palette = false) {
+    PNGEncoder::Options result;
+    result.level = level;
+    result.filter = filter;
+    result.palette = palette;
+    return result;
+}
+
+} // namespace
+
+static void Util_encodePNG(::benchmark::State& state) {
+    const PremultipliedImage image = decodeImage(util::read_file("test/fixtures/map/offline/expected.png"));
+    std::size_t size = 0;
+
+    while (state.KeepRunning()) {
+        size = encodePNG(image).size();
+    }
+
+    state.SetBytesProcessed(state.iterations() * image.bytes());
+    state.SetLabel((std::to_string(size) + " bytes").c_str());
+}
+
+static void Util_encodePNG_Unfiltered(::benchmark::State& state) {
+    encode(state, options(-1, PNGEncoder::Filter::None));
+}
+
+static void Util_encodePNG_Adaptive(::benchmark::State& state) {
+    encode(state, options(state.range(0), PNGEncoder::Filter::Adaptive));
+}
+
+static void Util_encodePNG_Paeth(::benchmark::State& state) {
+    encode(state, options(state.range(0), PNGEncoder::Filter::Paeth));
+}
+
+static void Util_encodePNG_Palette(::benchmark::State& state) {
+    encode(state, options(state.range(0), PNGEncoder::Filter::None, true));
+}
+
+BENCHMARK(Util_encodePNG);
+BENCHMARK(Util_encodePNG_Unfiltered);
+BENCHMARK(Util_encodePNG_Adaptive)->Arg(1)->Arg(6)->Arg(9);
+BENCHMARK(Util_encodePNG_Paeth)->Arg(1)->Arg(6)->Arg(9);
+BENCHMARK(Util_encodePNG_Palette)->Arg(1)->Arg(6)->Arg(9);
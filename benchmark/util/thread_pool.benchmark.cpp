@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/actor/actor.hpp>
+#include <mbgl/util/default_thread_pool.hpp>
+#include <mbgl/util/work_stealing_thread_pool.hpp>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+// Mimics tile layout: every tile worker gets a burst of messages of uneven
+// cost and reports each result to a single collector, like a tile does.
+class Collector {
+public:
+    Collector(ActorRef<Collector>, std::size_t expected_, std::promise<void> done_)
+        : expected(expected_), done(std::move(done_)) {
+    }
+
+    void collect(uint64_t result) {
+        sum += result;
+        if (++received == expected) {
+            done.set_value();
+        }
+    }
+
+private:
+    const std::size_t expected;
+    std::size_t received = 0;
+    uint64_t sum = 0;
+    std::promise<void> done;
+};
+
+class Worker {
+public:
+    Worker(ActorRef<Worker>, ActorRef<Collector> collector_)
+        : collector(std::move(collector_)) {
+    }
+
+    void layout(uint32_t cost) {
+        uint64_t result = cost;
+        for (uint32_t i = 0; i < cost; ++i) {
+            result = result * 6364136223846793005ull + 1442695040888963407ull;
+        }
+        benchmark::DoNotOptimize(result);
+        collector.invoke(&Collector::collect, result);
+    }
+
+private:
+    ActorRef<Collector> collector;
+};
+
+template <class Pool>
+void fanOut(::benchmark::State& state) {
+    const std::size_t tiles = state.range(0);
+    const std::size_t messages = 16;
+
+    Pool pool(4);
+
+    while (state.KeepRunning()) {
+        std::promise<void> promise;
+        std::future<void> done = promise.get_future();
+        Actor<Collector> collector(pool, tiles * messages, std::move(promise));
+
+        std::vector<std::unique_ptr<Actor<Worker>>> workers;
+        workers.reserve(tiles);
+        for (std::size_t i = 0; i < tiles; ++i) {
+            workers.push_back(std::make_unique<Actor<Worker>>(pool, collector.self()));
+        }
+        for (std::size_t m = 0; m < messages; ++m) {
+            for (std::size_t i = 0; i < tiles; ++i) {
+                // Some tiles are much denser than others.
+                workers[i]->invoke(&Worker::layout, uint32_t(i % 8 == 0 ? 20000 : 500));
+            }
+        }
+
+        done.wait();
+    }
+
+    state.SetItemsProcessed(state.iterations() * tiles * messages);
+}
+
+} // namespace
+
+static void Util_ThreadPoolFanOut(::benchmark::State& state) {
+    fanOut<ThreadPool>(state);
+}
+
+static void Util_WorkStealingThreadPoolFanOut(::benchmark::State& state) {
+    fanOut<WorkStealingThreadPool>(state);
+}
+
+BENCHMARK(Util_ThreadPoolFanOut)->Arg(16)->Arg(64)->Arg(256)->UseRealTime();
+BENCHMARK(Util_WorkStealingThreadPoolFanOut)->Arg(16)->Arg(64)->Arg(256)->UseRealTime();
@@ -21,8 +21,25 @@ target_sources(alk-rts
     PRIVATE alk/Tile.hpp
     PRIVATE alk/TileHandler.cpp
     PRIVATE alk/TileHandler.hpp
+    PRIVATE alk/AssetHandler.cpp
+    PRIVATE alk/AssetHandler.hpp
+    PRIVATE alk/AssetSource.cpp
+    PRIVATE alk/AssetSource.hpp
+    PRIVATE alk/SharedIOBuf.hpp
+    PRIVATE alk/TileMemoryCache.cpp
+    PRIVATE alk/TileMemoryCache.hpp
+    PRIVATE alk/TileRouter.cpp
+    PRIVATE alk/TileRouter.hpp
     PRIVATE alk/StatsHandler.cpp
     PRIVATE alk/StatsHandler.hpp
+    PRIVATE alk/CacheStatsHandler.cpp
+    PRIVATE alk/CacheStatsHandler.hpp
+    PRIVATE alk/MetricsHandler.cpp
+    PRIVATE alk/MetricsHandler.hpp
+    PRIVATE alk/PipelineStatsHandler.cpp
+    PRIVATE alk/PipelineStatsHandler.hpp
+    PRIVATE alk/ReadinessHandler.cpp
+    PRIVATE alk/ReadinessHandler.hpp
     PRIVATE alk/TileLoader.cpp
     PRIVATE alk/TileLoader.hpp
     PRIVATE alk/TilePath.cpp
@@ -34,6 +51,20 @@ target_sources(alk-rts
     PRIVATE alk/Map.cpp
     PRIVATE alk/RenderCache.hpp
     PRIVATE alk/RenderCache.cpp
+    PRIVATE alk/RenderPool.hpp
+    PRIVATE alk/RenderPool.cpp
+    PRIVATE alk/StyleSnapshot.hpp
+    PRIVATE alk/StyleSnapshot.cpp
+    PRIVATE alk/EncodePool.hpp
+    PRIVATE alk/EncodePool.cpp
+    PRIVATE alk/Metrics.hpp
+    PRIVATE alk/AccessLog.hpp
+    PRIVATE alk/AccessLog.cpp
+    PRIVATE alk/Metrics.cpp
+    PRIVATE alk/ExpirationPolicy.hpp
+    PRIVATE alk/ExpirationPolicy.cpp
+    PRIVATE alk/TileEncoder.hpp
+    PRIVATE alk/TileEncoder.cpp
     PRIVATE alk/compress.hpp
     PRIVATE alk/compress.cpp
 )
@@ -70,8 +101,162 @@ target_add_mason_package(alk-rts PRIVATE variant)
 target_add_mason_package(alk-rts PRIVATE boost)
 target_add_mason_package(alk-rts PRIVATE boost_libprogram_options)
 
+add_executable(alk-seed
+    alk/TileSeeder.cpp
+)
+
+target_sources(alk-seed
+    PRIVATE alk/RasterTileRenderer.cpp
+    PRIVATE alk/RasterTileRenderer.hpp
+    PRIVATE alk/MbTilesDatabase.cpp
+    PRIVATE alk/MbTilesDatabase.hpp
+    PRIVATE alk/MbTilesFileSource.cpp
+    PRIVATE alk/MbTilesFileSource.hpp
+    PRIVATE alk/SourcesFileSource.cpp
+    PRIVATE alk/SourcesFileSource.hpp
+    PRIVATE alk/SourcesDefaultFileSource.cpp
+    PRIVATE alk/SourcesDefaultFileSource.hpp
+    PRIVATE alk/SourceSpec.cpp
+    PRIVATE alk/SourceSpec.hpp
+    PRIVATE alk/SourcesSpecLoader.cpp
+    PRIVATE alk/SourcesSpecLoader.hpp
+    PRIVATE alk/Tile.cpp
+    PRIVATE alk/Tile.hpp
+    PRIVATE alk/TileLoader.cpp
+    PRIVATE alk/TileLoader.hpp
+    PRIVATE alk/TilePath.cpp
+    PRIVATE alk/TilePath.hpp
+    PRIVATE alk/Frontend.hpp
+    PRIVATE alk/Frontend.cpp
+    PRIVATE alk/Map.hpp
+    PRIVATE alk/Map.cpp
+    PRIVATE alk/RenderCache.hpp
+    PRIVATE alk/RenderCache.cpp
+    PRIVATE alk/RenderPool.hpp
+    PRIVATE alk/RenderPool.cpp
+    PRIVATE alk/StyleSnapshot.hpp
+    PRIVATE alk/StyleSnapshot.cpp
+    PRIVATE alk/EncodePool.hpp
+    PRIVATE alk/EncodePool.cpp
+    PRIVATE alk/Metrics.hpp
+    PRIVATE alk/AccessLog.hpp
+    PRIVATE alk/AccessLog.cpp
+    PRIVATE alk/Metrics.cpp
+    PRIVATE alk/ExpirationPolicy.hpp
+    PRIVATE alk/ExpirationPolicy.cpp
+    PRIVATE alk/TileEncoder.hpp
+    PRIVATE alk/TileEncoder.cpp
+    PRIVATE alk/compress.hpp
+    PRIVATE alk/compress.cpp
+)
+
+target_compile_options(alk-seed
+    PRIVATE -ggdb
+)
+target_include_directories(alk-seed
+    PRIVATE platform/default
+    PRIVATE src
+)
+
+target_link_libraries(alk-seed
+    PUBLIC pthread
+    PRIVATE mbgl-core
+    PRIVATE mbgl-filesource
+    PRIVATE mbgl-loop-uv
+)
+
+target_add_mason_package(alk-seed PRIVATE cheap-ruler)
+target_add_mason_package(alk-seed PRIVATE unique_resource)
+target_add_mason_package(alk-seed PRIVATE geojson)
+target_add_mason_package(alk-seed PRIVATE geometry)
+target_add_mason_package(alk-seed PRIVATE rapidjson)
+target_add_mason_package(alk-seed PRIVATE libuv)
+target_add_mason_package(alk-seed PRIVATE variant)
+target_add_mason_package(alk-seed PRIVATE boost)
+target_add_mason_package(alk-seed PRIVATE boost_libprogram_options)
+
+add_executable(alk-test
+    alk/test/main.cpp
+)
+
+target_sources(alk-test
+    PRIVATE alk/test/raster_tile_renderer.test.cpp
+    PRIVATE alk/test/tile_router.test.cpp
+    PRIVATE test/src/mbgl/test/stub_file_source.cpp
+    PRIVATE test/src/mbgl/test/stub_file_source.hpp
+    PRIVATE alk/RasterTileRenderer.cpp
+    PRIVATE alk/RasterTileRenderer.hpp
+    PRIVATE alk/TilePath.cpp
+    PRIVATE alk/TilePath.hpp
+    PRIVATE alk/Frontend.hpp
+    PRIVATE alk/Frontend.cpp
+    PRIVATE alk/RenderCache.hpp
+    PRIVATE alk/RenderCache.cpp
+    PRIVATE alk/StyleSnapshot.hpp
+    PRIVATE alk/StyleSnapshot.cpp
+    PRIVATE alk/EncodePool.hpp
+    PRIVATE alk/EncodePool.cpp
+    PRIVATE alk/Metrics.hpp
+    PRIVATE alk/Metrics.cpp
+    PRIVATE alk/AccessLog.hpp
+    PRIVATE alk/AccessLog.cpp
+    PRIVATE alk/ExpirationPolicy.hpp
+    PRIVATE alk/ExpirationPolicy.cpp
+    PRIVATE alk/TileEncoder.hpp
+    PRIVATE alk/TileEncoder.cpp
+    PRIVATE alk/TileRouter.hpp
+    PRIVATE alk/TileRouter.cpp
+)
+
+target_include_directories(alk-test
+    PRIVATE alk
+    PRIVATE platform/default
+    PRIVATE src
+    PRIVATE test/include
+    PRIVATE test/src
+)
+
+target_link_libraries(alk-test
+    PUBLIC pthread
+    PRIVATE mbgl-core
+    PRIVATE mbgl-filesource
+    PRIVATE mbgl-loop-uv
+)
+
+target_add_mason_package(alk-test PRIVATE gtest)
+target_add_mason_package(alk-test PRIVATE unique_resource)
+target_add_mason_package(alk-test PRIVATE geojson)
+target_add_mason_package(alk-test PRIVATE geometry)
+target_add_mason_package(alk-test PRIVATE rapidjson)
+target_add_mason_package(alk-test PRIVATE libuv)
+target_add_mason_package(alk-test PRIVATE variant)
+target_add_mason_package(alk-test PRIVATE boost)
+
+add_executable(alk-benchmark
+    alk/benchmark/main.cpp
+)
+
+target_sources(alk-benchmark
+    PRIVATE alk/benchmark/router.benchmark.cpp
+    PRIVATE alk/TileRouter.cpp
+    PRIVATE alk/TileRouter.hpp
+)
+
+target_include_directories(alk-benchmark
+    PRIVATE alk
+)
+
+target_link_libraries(alk-benchmark
+    PUBLIC pthread
+)
+
+target_add_mason_package(alk-benchmark PRIVATE benchmark)
+
 alk_rts()
 
 create_source_groups(alk-rts)
+create_source_groups(alk-seed)
+create_source_groups(alk-test)
+create_source_groups(alk-benchmark)
 
 
@@ -25,6 +25,11 @@ set(MBGL_BENCHMARK_FILES
     benchmark/src/mbgl/benchmark/benchmark.cpp
     benchmark/src/mbgl/benchmark/stub_geometry_tile_feature.hpp
 
+    # storage
+    benchmark/storage/offline_database.benchmark.cpp
+
     # util
     benchmark/util/dtoa.benchmark.cpp
+    benchmark/util/png.benchmark.cpp
+    benchmark/util/thread_pool.benchmark.cpp
 )
@@ -6,8 +6,10 @@ set(MBGL_CORE_FILES
     include/mbgl/actor/actor_ref.hpp
     include/mbgl/actor/mailbox.hpp
     include/mbgl/actor/message.hpp
+    include/mbgl/actor/message_pool.hpp
     include/mbgl/actor/scheduler.hpp
     src/mbgl/actor/mailbox.cpp
+    src/mbgl/actor/message_pool.cpp
     src/mbgl/actor/scheduler.cpp
 
     # algorithm
@@ -336,6 +338,8 @@ set(MBGL_CORE_FILES
     include/mbgl/style/types.hpp
     include/mbgl/style/undefined.hpp
     src/mbgl/style/collection.hpp
+    src/mbgl/style/compiled_filter.cpp
+    src/mbgl/style/compiled_filter.hpp
     src/mbgl/style/custom_tile_loader.cpp
     src/mbgl/style/custom_tile_loader.hpp
     src/mbgl/style/image.cpp
@@ -619,6 +623,7 @@ set(MBGL_CORE_FILES
     include/mbgl/util/noncopyable.hpp
     include/mbgl/util/optional.hpp
     include/mbgl/util/platform.hpp
+    include/mbgl/util/png_encoder.hpp
     include/mbgl/util/premultiply.hpp
     include/mbgl/util/projection.hpp
     include/mbgl/util/range.hpp
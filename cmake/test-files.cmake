@@ -4,6 +4,8 @@ set(MBGL_TEST_FILES
     # actor
     test/actor/actor.test.cpp
     test/actor/actor_ref.test.cpp
+    test/actor/mailbox.test.cpp
+    test/actor/message_pool.test.cpp
 
     # algorithm
     test/algorithm/covered_by_children.test.cpp
@@ -149,4 +151,5 @@ set(MBGL_TEST_FILES
     test/util/token.test.cpp
     test/util/unique_any.test.cpp
     test/util/url.test.cpp
+    test/util/work_stealing_thread_pool.test.cpp
 )
@@ -82,6 +82,11 @@ public:
         return future;
     }
 
+    // A hint for the scheduler; see `Scheduler::schedule`.
+    void setPriority(Scheduler::Priority priority) {
+        mailbox->setPriority(priority);
+    }
+
     ActorRef<std::decay_t<Object>> self() {
         return ActorRef<std::decay_t<Object>>(object, mailbox);
     }
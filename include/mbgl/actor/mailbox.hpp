@@ -1,35 +1,56 @@
 #pragma once
 
+#include <mbgl/actor/scheduler.hpp>
+
+#include <atomic>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <thread>
 
 namespace mbgl {
 
-class Scheduler;
 class Message;
 
 class Mailbox : public std::enable_shared_from_this<Mailbox> {
 public:
     Mailbox(Scheduler&);
+    ~Mailbox();
 
     void push(std::unique_ptr<Message>);
 
+    // Takes effect the next time the mailbox is scheduled.
+    void setPriority(Scheduler::Priority);
+
     void close();
     void receive();
 
     static void maybeReceive(std::weak_ptr<Mailbox>);
 
 private:
+    void enqueue(Message*);
+    Message* dequeue();
+    void doneReceiving(std::thread::id);
+
     Scheduler& scheduler;
+    std::atomic<Scheduler::Priority> priority { Scheduler::defaultPriority };
+
+    std::atomic<bool> closed { false };
+    std::atomic<std::size_t> pushing { 0 };
+    std::atomic<std::thread::id> receiving { std::thread::id() };
 
-    std::recursive_mutex receivingMutex;
-    std::mutex pushingMutex;
+    // Only used by close() to wait for a receive() on another thread.
+    std::mutex closingMutex;
+    std::condition_variable receiveDone;
 
-    bool closed { false };
+    // The number of messages queued, plus the one being received.
+    std::atomic<std::size_t> size { 0 };
 
-    std::mutex queueMutex;
-    std::queue<std::unique_ptr<Message>> queue;
+    // An intrusive multiple-producer, single-consumer queue. Senders link
+    // messages after `head`; the receiver takes them from `tail`.
+    std::unique_ptr<Message> stub;
+    std::atomic<Message*> head;
+    Message* tail;
 };
 
 } // namespace mbgl
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <mbgl/actor/message_pool.hpp>
 #include <mbgl/util/optional.hpp>
 
+#include <atomic>
 #include <future>
 #include <utility>
 
@@ -10,10 +12,24 @@ namespace mbgl {
 // A movable type-erasing function wrapper. This allows to store arbitrary invokable
 // things (like std::function<>, or the result of a movable-only std::bind()) in the queue.
 // Source: http://stackoverflow.com/a/29642072/331379
+// Messages are allocated from the sending thread's MessagePool, if it has one, and
+// double as the nodes of the Mailbox queue.
 class Message {
 public:
     virtual ~Message() = default;
     virtual void operator()() = 0;
+
+    static void* operator new(std::size_t size) {
+        return MessagePool::allocate(size);
+    }
+
+    static void operator delete(void* ptr, std::size_t size) {
+        MessagePool::deallocate(ptr, size);
+    }
+
+private:
+    friend class Mailbox;
+    std::atomic<Message*> next { nullptr };
 };
 
 template <class Object, class MemberFn, class ArgsTuple>
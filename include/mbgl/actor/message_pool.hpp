@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace mbgl {
+
+/*
+    Recycles the memory of `Message`s on the thread it's created on.
+
+    Messages are small and short-lived: one is allocated for every `invoke()`,
+    and freed by whichever thread receives it. While a `MessagePool` exists, the
+    messages freed on its thread are kept in free lists, one per size class,
+    and reused for the messages sent from that thread. Threads without a pool,
+    and messages too large for any size class, use the global heap.
+
+    Create one at the top of a long-lived thread that sends or receives many
+    messages, like the threads of a `ThreadPool`. A pool must be destroyed on
+    the thread that created it.
+*/
+class MessagePool {
+public:
+    MessagePool();
+    ~MessagePool();
+
+    MessagePool(const MessagePool&) = delete;
+    MessagePool& operator=(const MessagePool&) = delete;
+
+    static void* allocate(std::size_t size);
+    static void deallocate(void* ptr, std::size_t size);
+
+private:
+    struct Block {
+        Block* next;
+    };
+
+    static constexpr std::size_t classCount = 4;
+
+    MessagePool* previous;
+    std::array<Block*, classCount> blocks {};
+    std::array<std::size_t, classCount> counts {};
+};
+
+} // namespace mbgl
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 
 namespace mbgl {
@@ -30,8 +31,16 @@ class Mailbox;
 */
 class Scheduler {
 public:
+    // Lower values are more urgent. Mailboxes have `defaultPriority` unless
+    // their owner sets another; see `Mailbox::setPriority`.
+    using Priority = uint32_t;
+    static constexpr Priority defaultPriority = 0;
+
     virtual ~Scheduler() = default;
-    virtual void schedule(std::weak_ptr<Mailbox>) = 0;
+
+    // The priority is a hint. `ThreadPool` processes the most urgent of the
+    // mailboxes waiting for a thread first; other schedulers may ignore it.
+    virtual void schedule(std::weak_ptr<Mailbox>, Priority) = 0;
 
     // Set/Get the current Scheduler for this thread
     static Scheduler* GetCurrent();
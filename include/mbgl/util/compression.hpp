@@ -6,6 +6,8 @@ namespace mbgl {
 namespace util {
 
 std::string compress(const std::string& raw);
+// level ranges from 0 (fastest) to 9 (smallest); -1 is zlib's default.
+std::string compress(const std::string& raw, int level);
 std::string decompress(const std::string& raw);
 
 } // namespace util
@@ -173,5 +173,8 @@ using AlphaImage = Image<ImageAlphaMode::Exclusive>;
 // TODO: don't use std::string for binary data.
 PremultipliedImage decodeImage(const std::string&);
 std::string encodePNG(const PremultipliedImage&);
+// quality ranges from 0 (smallest) to 100 (best).
+std::string encodeJPEG(const PremultipliedImage&, int quality = 85);
+std::string encodeWebP(const PremultipliedImage&, int quality = 80, bool lossless = false);
 
 } // namespace mbgl
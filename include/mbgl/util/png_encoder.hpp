@@ -0,0 +1,50 @@
+#pragma once
+
+#include <mbgl/util/image.hpp>
+#include <mbgl/util/noncopyable.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mbgl {
+
+// Implemented in platform/default/png_writer.cpp, which the Qt platform
+// doesn't build; there only encodePNG() is available.
+class PNGEncoder : private util::noncopyable {
+public:
+    enum class Filter : uint8_t {
+        None = 0,
+        Sub = 1,
+        Up = 2,
+        Paeth = 4,
+        // Picks the filter of each scanline that is likely to compress best.
+        Adaptive = 0xFF,
+    };
+
+    struct Options {
+        // Deflate level from 0 (fastest) to 9 (smallest). -1 is zlib's default.
+        int level = -1;
+        Filter filter = Filter::Adaptive;
+        // Quantizes the image to a palette of at most 256 colors (PNG8).
+        // Images that already have that few colors are encoded losslessly.
+        bool palette = false;
+    };
+
+    PNGEncoder();
+    explicit PNGEncoder(Options);
+
+    // Not thread safe; the encoder reuses its buffers between images.
+    std::string encode(const PremultipliedImage&);
+
+private:
+    std::string encodeTruecolor(const PremultipliedImage&);
+    std::string encodePalette(const PremultipliedImage&);
+
+    const Options options;
+    std::vector<uint8_t> rows;
+    std::vector<uint8_t> candidates;
+    std::string idat;
+};
+
+} // namespace mbgl
@@ -63,7 +63,7 @@ public:
         return std::make_unique<WorkRequest>(task);
     }
                     
-    void schedule(std::weak_ptr<Mailbox> mailbox) override {
+    void schedule(std::weak_ptr<Mailbox> mailbox, Priority) override {
         invoke([mailbox] () {
             Mailbox::maybeReceive(mailbox);
         });
@@ -2,6 +2,7 @@
 
 #include <mbgl/actor/actor.hpp>
 #include <mbgl/actor/mailbox.hpp>
+#include <mbgl/actor/message_pool.hpp>
 #include <mbgl/actor/scheduler.hpp>
 #include <mbgl/util/platform.hpp>
 #include <mbgl/util/run_loop.hpp>
@@ -47,6 +48,7 @@ public:
             platform::setCurrentThreadName(name);
             platform::makeThreadLowPriority();
 
+            MessagePool messagePool;
             util::RunLoop loop_(util::RunLoop::Type::New);
             loop = &loop_;
 
@@ -127,7 +129,7 @@ public:
 private:
     MBGL_STORE_THREAD(tid);
 
-    void schedule(std::weak_ptr<Mailbox> mailbox) override {
+    void schedule(std::weak_ptr<Mailbox> mailbox, Priority) override {
         {
             std::lock_guard<std::mutex> lock(mutex);
             queue.push(mailbox);
@@ -57,6 +57,8 @@ macro(mbgl_platform_core)
         PRIVATE platform/default/mbgl/util/shared_thread_pool.hpp
         PRIVATE platform/default/mbgl/util/default_thread_pool.cpp
         PRIVATE platform/default/mbgl/util/default_thread_pool.hpp
+        PRIVATE platform/default/mbgl/util/work_stealing_thread_pool.cpp
+        PRIVATE platform/default/mbgl/util/work_stealing_thread_pool.hpp
 
         # Rendering
         PRIVATE platform/android/src/android_renderer_backend.cpp
@@ -71,7 +71,7 @@ public:
 
     // From Scheduler. Schedules by using callbacks to the
     // JVM to process the mailbox on the right thread.
-    void schedule(std::weak_ptr<Mailbox> scheduled) override;
+    void schedule(std::weak_ptr<Mailbox> scheduled, Priority) override;
 
     void requestRender();
 
@@ -34,6 +34,14 @@ public:
         }
     }
 
+    void deactivateContext() final {
+        // OSMesa contexts are bound per thread; release ours so that each
+        // backend only ever owns the thread that is currently driving it.
+        if (!OSMesaMakeCurrent(nullptr, nullptr, GL_UNSIGNED_BYTE, 0, 0)) {
+            throw std::runtime_error("Removing OpenGL context failed.\n");
+        }
+    }
+
 private:
     OSMesaContext glContext = nullptr;
     GLubyte fakeBuffer = 0;
@@ -0,0 +1,122 @@
+#include <mbgl/util/image.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+extern "C"
+{
+#include <jpeglib.h>
+}
+
+namespace mbgl {
+
+const static unsigned BUF_SIZE = 4096;
+
+struct jpeg_string_wrapper {
+    jpeg_destination_mgr manager;
+    std::string* out;
+    JOCTET buffer[BUF_SIZE];
+};
+
+static void init_destination(j_compress_ptr cinfo) {
+    auto* wrap = reinterpret_cast<jpeg_string_wrapper*>(cinfo->dest);
+    wrap->manager.next_output_byte = wrap->buffer;
+    wrap->manager.free_in_buffer = BUF_SIZE;
+}
+
+static boolean empty_output_buffer(j_compress_ptr cinfo) {
+    auto* wrap = reinterpret_cast<jpeg_string_wrapper*>(cinfo->dest);
+    wrap->out->append(reinterpret_cast<const char*>(wrap->buffer), BUF_SIZE);
+    wrap->manager.next_output_byte = wrap->buffer;
+    wrap->manager.free_in_buffer = BUF_SIZE;
+    return TRUE;
+}
+
+static void term_destination(j_compress_ptr cinfo) {
+    auto* wrap = reinterpret_cast<jpeg_string_wrapper*>(cinfo->dest);
+    wrap->out->append(reinterpret_cast<const char*>(wrap->buffer), BUF_SIZE - wrap->manager.free_in_buffer);
+}
+
+static void attach_string(j_compress_ptr cinfo, std::string* out) {
+    if (cinfo->dest == nullptr) {
+        cinfo->dest = (struct jpeg_destination_mgr *)
+            (*cinfo->mem->alloc_small) ((j_common_ptr) cinfo, JPOOL_PERMANENT, sizeof(jpeg_string_wrapper));
+    }
+    auto * dest = reinterpret_cast<jpeg_string_wrapper*> (cinfo->dest);
+    dest->manager.init_destination = init_destination;
+    dest->manager.empty_output_buffer = empty_output_buffer;
+    dest->manager.term_destination = term_destination;
+    dest->out = out;
+}
+
+static void on_error(j_common_ptr cinfo) {
+    char buffer[JMSG_LENGTH_MAX];
+    (*cinfo->err->format_message)(cinfo, buffer);
+    throw std::runtime_error(std::string("JPEG Writer: libjpeg could not write image: ") + buffer);
+}
+
+static void on_error_message(j_common_ptr) {}
+
+struct jpeg_compress_guard {
+    jpeg_compress_guard(jpeg_compress_struct* cinfo)
+        : i_(cinfo) {}
+
+    ~jpeg_compress_guard() {
+        jpeg_destroy_compress(i_);
+    }
+
+    jpeg_compress_struct* i_;
+};
+
+// JPEG has no alpha channel. Translucent pixels end up composited over
+// black, which is what their premultiplied color already is.
+std::string encodeJPEG(const PremultipliedImage& pre, int quality) {
+    std::string jpeg;
+
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jerr.error_exit = on_error;
+    jerr.output_message = on_error_message;
+    jpeg_create_compress(&cinfo);
+    jpeg_compress_guard cguard(&cinfo);
+    attach_string(&cinfo, &jpeg);
+
+    cinfo.image_width = pre.size.width;
+    cinfo.image_height = pre.size.height;
+#ifdef JCS_EXTENSIONS
+    // libjpeg-turbo reads RGBA scanlines directly and skips the alpha byte.
+    cinfo.input_components = 4;
+    cinfo.in_color_space = JCS_EXT_RGBX;
+#else
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+#endif
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+
+#ifndef JCS_EXTENSIONS
+    std::unique_ptr<JSAMPLE[]> rgb = std::make_unique<JSAMPLE[]>(pre.size.width * 3);
+#endif
+    while (cinfo.next_scanline < cinfo.image_height) {
+        const uint8_t* src = pre.data.get() + cinfo.next_scanline * pre.stride();
+#ifdef JCS_EXTENSIONS
+        JSAMPROW row = const_cast<JSAMPROW>(src);
+#else
+        for (uint32_t i = 0; i < pre.size.width; ++i) {
+            rgb[3 * i + 0] = src[4 * i + 0];
+            rgb[3 * i + 1] = src[4 * i + 1];
+            rgb[3 * i + 2] = src[4 * i + 2];
+        }
+        JSAMPROW row = rgb.get();
+#endif
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+
+    jpeg_finish_compress(&cinfo);
+    return jpeg;
+}
+
+} // namespace mbgl
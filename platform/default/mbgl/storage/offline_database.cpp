@@ -172,6 +172,82 @@ std::pair<bool, uint64_t> OfflineDatabase::put(const Resource& resource, const R
     return putInternal(resource, response, true);
 }
 
+std::vector<std::pair<bool, uint64_t>> OfflineDatabase::putBatch(const std::vector<std::pair<Resource, Response>>& entries) {
+    std::vector<std::pair<bool, uint64_t>> results;
+    results.reserve(entries.size());
+
+    uint64_t neededFreeSize = 0;
+    for (const auto& entry : entries) {
+        if (!entry.second.error && entry.second.data) {
+            neededFreeSize += entry.second.data->size();
+        }
+    }
+
+    if (!evict(neededFreeSize)) {
+        Log::Debug(Event::Database, "Unable to make space for entries");
+        results.resize(entries.size(), { false, 0 });
+        return results;
+    }
+
+    mapbox::sqlite::Transaction transaction(*db, mapbox::sqlite::Transaction::Immediate);
+    batching = true;
+    try {
+        for (const auto& entry : entries) {
+            results.push_back(putInternal(entry.first, entry.second, false));
+        }
+    } catch (...) {
+        batching = false;
+        throw;
+    }
+    batching = false;
+    transaction.commit();
+
+    return results;
+}
+
+void OfflineDatabase::setWriteAheadLog(bool enabled) {
+    if (enabled) {
+        db->exec("PRAGMA journal_mode = WAL");
+        db->exec("PRAGMA synchronous = NORMAL");
+    } else {
+        db->exec("PRAGMA journal_mode = DELETE");
+        db->exec("PRAGMA synchronous = FULL");
+    }
+}
+
+void OfflineDatabase::setCompressionPolicy(Resource::Kind kind, CompressionPolicy policy) {
+    compressionPolicies.at(kind) = policy;
+}
+
+OfflineDatabase::CompressionPolicy OfflineDatabase::getCompressionPolicy(Resource::Kind kind) const {
+    return kind < compressionPolicies.size() ? compressionPolicies[kind] : CompressionPolicy::Auto;
+}
+
+// Returns true if the data starts with the signature of a format that is already
+// entropy coded, and so won't get any smaller when deflated.
+static bool isCompressedFormat(const std::string& data) {
+    auto startsWith = [&] (const char* magic, std::size_t length, std::size_t offset = 0) {
+        return data.size() >= offset + length && data.compare(offset, length, magic, length) == 0;
+    };
+
+    return startsWith("\x89PNG\r\n\x1a\n", 8) ||         // PNG
+           startsWith("\xff\xd8\xff", 3) ||                // JPEG
+           (startsWith("RIFF", 4) && startsWith("WEBP", 4, 8)) || // WebP
+           startsWith("\x1f\x8b", 2);                      // gzip
+}
+
+static bool shouldCompress(OfflineDatabase::CompressionPolicy policy, const std::string& data) {
+    switch (policy) {
+    case OfflineDatabase::CompressionPolicy::Always:
+        return true;
+    case OfflineDatabase::CompressionPolicy::Never:
+        return false;
+    case OfflineDatabase::CompressionPolicy::Auto:
+    default:
+        return !isCompressedFormat(data);
+    }
+}
+
 std::pair<bool, uint64_t> OfflineDatabase::putInternal(const Resource& resource, const Response& response, bool evict_) {
     if (response.error) {
         return { false, 0 };
@@ -182,8 +258,10 @@ std::pair<bool, uint64_t> OfflineDatabase::putInternal(const Resource& resource,
     uint64_t size = 0;
 
     if (response.data) {
-        compressedData = util::compress(*response.data);
-        compressed = compressedData.size() < response.data->size();
+        if (shouldCompress(getCompressionPolicy(resource.kind), *response.data)) {
+            compressedData = util::compress(*response.data);
+            compressed = compressedData.size() < response.data->size();
+        }
         size = compressed ? compressedData.size() : response.data->size();
     }
 
@@ -292,8 +370,11 @@ bool OfflineDatabase::putResource(const Resource& resource,
     // We can't use REPLACE because it would change the id value.
 
     // Begin an immediate-mode transaction to ensure that two writers do not attempt
-    // to INSERT a resource at the same moment.
-    mapbox::sqlite::Transaction transaction(*db, mapbox::sqlite::Transaction::Immediate);
+    // to INSERT a resource at the same moment. A batch already holds one.
+    optional<mapbox::sqlite::Transaction> transaction;
+    if (!batching) {
+        transaction.emplace(*db, mapbox::sqlite::Transaction::Immediate);
+    }
 
     // clang-format off
     Statement update = getStatement(
@@ -327,7 +408,9 @@ bool OfflineDatabase::putResource(const Resource& resource,
 
     update->run();
     if (update->changes() != 0) {
-        transaction.commit();
+        if (transaction) {
+            transaction->commit();
+        }
         return false;
     }
 
@@ -354,7 +437,9 @@ bool OfflineDatabase::putResource(const Resource& resource,
     }
 
     insert->run();
-    transaction.commit();
+    if (transaction) {
+        transaction->commit();
+    }
 
     return true;
 }
@@ -481,8 +566,11 @@ bool OfflineDatabase::putTile(const Resource::TileData& tile,
     // We can't use REPLACE because it would change the id value.
 
     // Begin an immediate-mode transaction to ensure that two writers do not attempt
-    // to INSERT a resource at the same moment.
-    mapbox::sqlite::Transaction transaction(*db, mapbox::sqlite::Transaction::Immediate);
+    // to INSERT a resource at the same moment. A batch already holds one.
+    optional<mapbox::sqlite::Transaction> transaction;
+    if (!batching) {
+        transaction.emplace(*db, mapbox::sqlite::Transaction::Immediate);
+    }
 
     // clang-format off
     Statement update = getStatement(
@@ -522,7 +610,9 @@ bool OfflineDatabase::putTile(const Resource::TileData& tile,
 
     update->run();
     if (update->changes() != 0) {
-        transaction.commit();
+        if (transaction) {
+            transaction->commit();
+        }
         return false;
     }
 
@@ -552,7 +642,9 @@ bool OfflineDatabase::putTile(const Resource::TileData& tile,
     }
 
     insert->run();
-    transaction.commit();
+    if (transaction) {
+        transaction->commit();
+    }
 
     return true;
 }
@@ -7,9 +7,12 @@
 #include <mbgl/util/constants.hpp>
 #include <mbgl/util/mapbox.hpp>
 
+#include <array>
 #include <unordered_map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace mapbox {
 namespace sqlite {
@@ -25,6 +28,16 @@ class TileID;
 
 class OfflineDatabase : private util::noncopyable {
 public:
+    // Determines whether put() deflates data before storing it.
+    enum class CompressionPolicy : uint8_t {
+        // Store data that is already entropy coded (PNG, JPEG, WebP, gzip) as is,
+        // and compress everything else.
+        Auto,
+        // Always compress, keeping the result only if it is smaller.
+        Always,
+        Never
+    };
+
     // Limits affect ambient caching (put) only; resources required by offline
     // regions are exempt.
     OfflineDatabase(std::string path, uint64_t maximumCacheSize = util::DEFAULT_MAX_CACHE_SIZE);
@@ -35,6 +48,19 @@ public:
     // Return value is (inserted, stored size)
     std::pair<bool, uint64_t> put(const Resource&, const Response&);
 
+    // Stores all entries in a single transaction, making space for their combined
+    // size up front. Return value is (inserted, stored size) for each entry.
+    std::vector<std::pair<bool, uint64_t>> putBatch(const std::vector<std::pair<Resource, Response>>&);
+
+    // Switches between the default rollback journal with full syncs, and a write-ahead
+    // log with normal syncs, which lets readers proceed while a write is in progress.
+    // Only enable it for databases that hold nothing but ambient cache.
+    void setWriteAheadLog(bool);
+
+    // Overrides the compression policy for resources of the given kind.
+    void setCompressionPolicy(Resource::Kind, CompressionPolicy);
+    CompressionPolicy getCompressionPolicy(Resource::Kind) const;
+
     std::vector<OfflineRegion> listRegions();
 
     OfflineRegion createRegion(const OfflineRegionDefinition&,
@@ -110,6 +136,11 @@ private:
 
     uint64_t maximumCacheSize;
 
+    // True while putBatch() holds a transaction that individual puts must join.
+    bool batching = false;
+
+    std::array<CompressionPolicy, Resource::Kind::Image + 1> compressionPolicies {{}};
+
     uint64_t offlineMapboxTileCountLimit = util::mapbox::DEFAULT_OFFLINE_TILE_COUNT_LIMIT;
     optional<uint64_t> offlineMapboxTileCount;
 
@@ -1,5 +1,6 @@
 #include <mbgl/util/default_thread_pool.hpp>
 #include <mbgl/actor/mailbox.hpp>
+#include <mbgl/actor/message_pool.hpp>
 #include <mbgl/util/platform.hpp>
 #include <mbgl/util/string.hpp>
 
@@ -10,6 +11,7 @@ ThreadPool::ThreadPool(std::size_t count) {
     for (std::size_t i = 0; i < count; ++i) {
         threads.emplace_back([this, i]() {
             platform::setCurrentThreadName(std::string{ "Worker " } + util::toString(i + 1));
+            MessagePool messagePool;
 
             while (true) {
                 std::unique_lock<std::mutex> lock(mutex);
@@ -22,7 +24,7 @@ ThreadPool::ThreadPool(std::size_t count) {
                     return;
                 }
 
-                auto mailbox = queue.front();
+                auto mailbox = queue.top().mailbox;
                 queue.pop();
                 lock.unlock();
 
@@ -45,10 +47,10 @@ ThreadPool::~ThreadPool() {
     }
 }
 
-void ThreadPool::schedule(std::weak_ptr<Mailbox> mailbox) {
+void ThreadPool::schedule(std::weak_ptr<Mailbox> mailbox, Priority priority) {
     {
         std::lock_guard<std::mutex> lock(mutex);
-        queue.push(mailbox);
+        queue.push({ priority, sequence++, std::move(mailbox) });
     }
 
     cv.notify_one();
@@ -3,9 +3,12 @@
 #include <mbgl/actor/scheduler.hpp>
 
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <tuple>
+#include <vector>
 
 namespace mbgl {
 
@@ -14,11 +17,23 @@ public:
     ThreadPool(std::size_t count);
     ~ThreadPool() override;
 
-    void schedule(std::weak_ptr<Mailbox>) override;
+    void schedule(std::weak_ptr<Mailbox>, Priority) override;
 
 private:
+    // Ordered by priority, then by the order they were scheduled in.
+    struct Entry {
+        Priority priority;
+        uint64_t sequence;
+        std::weak_ptr<Mailbox> mailbox;
+
+        bool operator<(const Entry& rhs) const {
+            return std::tie(priority, sequence) > std::tie(rhs.priority, rhs.sequence);
+        }
+    };
+
     std::vector<std::thread> threads;
-    std::queue<std::weak_ptr<Mailbox>> queue;
+    std::priority_queue<Entry> queue;
+    uint64_t sequence = 0;
     std::mutex mutex;
     std::condition_variable cv;
     bool terminate { false };
@@ -0,0 +1,202 @@
+#include <mbgl/util/work_stealing_thread_pool.hpp>
+#include <mbgl/actor/mailbox.hpp>
+#include <mbgl/actor/message_pool.hpp>
+#include <mbgl/util/platform.hpp>
+#include <mbgl/util/string.hpp>
+
+namespace mbgl {
+
+namespace {
+
+// How many times an idle thread looks for work before it parks.
+constexpr int spins = 64;
+
+} // namespace
+
+constexpr std::size_t WorkStealingThreadPool::Deque::capacity;
+
+WorkStealingThreadPool::Deque::Deque()
+    : buffer(std::make_unique<std::atomic<Task*>[]>(capacity)) {
+}
+
+bool WorkStealingThreadPool::Deque::push(Task* task) {
+    const int64_t b = bottom.load(std::memory_order_relaxed);
+    const int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= int64_t(capacity)) {
+        return false;
+    }
+    buffer[b & (capacity - 1)].store(task, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::Deque::steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return nullptr;
+    }
+    Task* task = buffer[t & (capacity - 1)].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return task;
+}
+
+bool WorkStealingThreadPool::Deque::empty() const {
+    return top.load(std::memory_order_acquire) >= bottom.load(std::memory_order_acquire);
+}
+
+WorkStealingThreadPool::WorkStealingThreadPool(std::size_t count) {
+    workers.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        workers.emplace_back(std::make_unique<Worker>(i));
+    }
+    // All workers must exist before any thread starts stealing from them.
+    for (auto& worker : workers) {
+        Worker* self = worker.get();
+        worker->thread = std::thread([this, self]() {
+            platform::setCurrentThreadName(std::string{ "Worker " } + util::toString(self->index + 1));
+            MessagePool messagePool;
+            current.set(self);
+            run(*self);
+            current.set(nullptr);
+        });
+    }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(parkMutex);
+        terminate = true;
+    }
+
+    parked.notify_all();
+
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+
+    // Like ThreadPool, pending mailboxes are dropped.
+    for (auto& worker : workers) {
+        while (Task* task = worker->deque.steal()) {
+            delete task;
+        }
+    }
+    for (Task* task : injection) {
+        delete task;
+    }
+}
+
+void WorkStealingThreadPool::schedule(std::weak_ptr<Mailbox> mailbox, Priority) {
+    auto task = new Task { std::move(mailbox) };
+
+    Worker* worker = current.get();
+    if (!worker || !worker->deque.push(task)) {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        injection.push_back(task);
+        injected.fetch_add(1);
+    }
+
+    wake();
+}
+
+void WorkStealingThreadPool::wake() {
+    // Pairs with the fence in park(): either a parking thread sees the new
+    // task, or we see that it's parking.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (searching.load() != 0 || sleeping.load() == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(parkMutex);
+        wakeups++;
+    }
+    parked.notify_one();
+}
+
+void WorkStealingThreadPool::run(Worker& worker) {
+    while (!terminate) {
+        Task* task = find(worker);
+        if (!task) {
+            task = spin(worker);
+        }
+        if (!task) {
+            task = park(worker);
+        }
+        if (!task) {
+            return;
+        }
+
+        Mailbox::maybeReceive(task->mailbox);
+        delete task;
+    }
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::find(Worker& worker) {
+    if (Task* task = worker.deque.steal()) {
+        return task;
+    }
+
+    if (injected.load() != 0) {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        if (!injection.empty()) {
+            Task* task = injection.front();
+            injection.pop_front();
+            injected.fetch_sub(1);
+            return task;
+        }
+    }
+
+    // Start with the next worker, so thieves spread over their victims.
+    const std::size_t count = workers.size();
+    for (std::size_t i = 1; i < count; ++i) {
+        Worker& victim = *workers[(worker.index + i) % count];
+        if (!victim.deque.empty()) {
+            if (Task* task = victim.deque.steal()) {
+                return task;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::spin(Worker& worker) {
+    searching.fetch_add(1);
+    for (int i = 0; i < spins && !terminate; ++i) {
+        if (Task* task = find(worker)) {
+            // Schedulers don't wake anyone while we search, so the last thread
+            // to stop searching wakes another in case there's more to do.
+            if (searching.fetch_sub(1) == 1) {
+                wake();
+            }
+            return task;
+        }
+        std::this_thread::yield();
+    }
+    searching.fetch_sub(1);
+    return nullptr;
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::park(Worker& worker) {
+    std::unique_lock<std::mutex> lock(parkMutex);
+    sleeping.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Task* task = nullptr;
+    while (!terminate) {
+        // Look again now that schedulers can see we're parking.
+        if ((task = find(worker))) {
+            break;
+        }
+        parked.wait(lock, [this] { return wakeups > 0 || terminate; });
+        if (wakeups > 0) {
+            wakeups--;
+        }
+    }
+    sleeping.fetch_sub(1);
+    return task;
+}
+
+} // namespace mbgl
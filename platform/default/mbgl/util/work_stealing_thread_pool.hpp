@@ -0,0 +1,96 @@
+#pragma once
+
+#include <mbgl/actor/scheduler.hpp>
+#include <mbgl/util/thread_local.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mbgl {
+
+/*
+    A `Scheduler` that spreads mailboxes over its threads without a shared lock
+    on the hot path.
+
+    Every thread has a bounded lock-free deque. Mailboxes scheduled from one of
+    the pool's threads go to that thread's deque; mailboxes scheduled from
+    elsewhere, or that don't fit, go to a shared injection queue. A thread runs
+    its own mailboxes first, then those of the injection queue, and then steals
+    from the other threads. Threads that find nothing spin for a while before
+    they park, and a thread is only woken when none is spinning.
+
+    Priorities are ignored, and threads take their own mailboxes oldest first,
+    as thieves do, so a mailbox
+    that keeps rescheduling itself can't starve the others. As with `ThreadPool`,
+    a mailbox is only ever scheduled once at a time, so its messages are still
+    processed one at a time and in order.
+*/
+class WorkStealingThreadPool : public Scheduler {
+public:
+    WorkStealingThreadPool(std::size_t count);
+    ~WorkStealingThreadPool() override;
+
+    void schedule(std::weak_ptr<Mailbox>, Priority) override;
+
+private:
+    struct Task {
+        std::weak_ptr<Mailbox> mailbox;
+    };
+
+    // A Chase-Lev deque of fixed capacity. Only the owning thread pushes;
+    // any thread, the owner included, takes from the top.
+    class Deque {
+    public:
+        static constexpr std::size_t capacity = 1024;
+
+        Deque();
+
+        // Returns false if the deque is full.
+        bool push(Task*);
+        // Returns nullptr if the deque is empty or another thread won the race.
+        Task* steal();
+        bool empty() const;
+
+    private:
+        std::atomic<int64_t> top { 0 };
+        std::atomic<int64_t> bottom { 0 };
+        std::unique_ptr<std::atomic<Task*>[]> buffer;
+    };
+
+    class Worker {
+    public:
+        explicit Worker(std::size_t index_) : index(index_) {}
+
+        const std::size_t index;
+        Deque deque;
+        std::thread thread;
+    };
+
+    void run(Worker&);
+    Task* find(Worker&);
+    Task* spin(Worker&);
+    Task* park(Worker&);
+    void wake();
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    util::ThreadLocal<Worker> current;
+
+    std::mutex injectionMutex;
+    std::deque<Task*> injection;
+    std::atomic<std::size_t> injected { 0 };
+
+    std::atomic<std::size_t> searching { 0 };
+    std::atomic<std::size_t> sleeping { 0 };
+    std::mutex parkMutex;
+    std::condition_variable parked;
+    std::size_t wakeups = 0;
+    std::atomic<bool> terminate { false };
+};
+
+} // namespace mbgl
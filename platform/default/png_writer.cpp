@@ -1,14 +1,18 @@
+#include <mbgl/util/png_encoder.hpp>
 #include <mbgl/util/compression.hpp>
 #include <mbgl/util/image.hpp>
-#include <mbgl/util/premultiply.hpp>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wshadow"
 #include <boost/crc.hpp>
 #pragma GCC diagnostic pop
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
+#include <unordered_map>
 
 #define NETWORK_BYTE_UINT32(value)                                                                 \
     char(value >> 24), char(value >> 16), char(value >> 8), char(value >> 0)
@@ -33,48 +37,278 @@ void addChunk(std::string& png, const char* type, const char* data = "", const u
     png.append(crc, 4);
 }
 
-} // namespace
-
-namespace mbgl {
-
-// Encode PNGs without libpng.
-std::string encodePNG(const PremultipliedImage& pre) {
-    // Make copy of the image so that we can unpremultiply it.
-    const auto src = util::unpremultiply(pre.clone());
-
+std::string assemblePNG(const mbgl::Size& size, uint8_t colorType, const std::string& idat,
+                        const std::string& plte = "", const std::string& trns = "") {
     // PNG magic bytes
     const char preamble[8] = { char(0x89), 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
 
-    // IHDR chunk for our RGBA image.
     const char ihdr[13] = {
-        NETWORK_BYTE_UINT32(src.size.width),  // width
-        NETWORK_BYTE_UINT32(src.size.height), // height
-        8,                                    // bit depth == 8 bits
-        6,                                    // color type == RGBA
-        0,                                    // compression method == deflate
-        0,                                    // filter method == default
-        0,                                    // interlace method == none
+        NETWORK_BYTE_UINT32(size.width),  // width
+        NETWORK_BYTE_UINT32(size.height), // height
+        8,                                // bit depth == 8 bits
+        char(colorType),                  // color type == RGBA or palette
+        0,                                // compression method == deflate
+        0,                                // filter method == default
+        0,                                // interlace method == none
     };
 
-    // Prepare the (compressed) data chunk.
-    const auto stride = src.stride();
-    std::string idat;
-    for (uint32_t y = 0; y < src.size.height; y++) {
-        // Every scanline needs to be prefixed with one byte that indicates the filter type.
-        idat.append(1, 0); // filter type 0
-        idat.append((const char*)(src.data.get() + y * stride), stride);
-    }
-    idat = util::compress(idat);
-
-    // Assemble the PNG.
     std::string png;
-    png.reserve((8 /* preamble */) + (12 + 13 /* IHDR */) +
-                (12 + idat.size() /* IDAT */) + (12 /* IEND */));
+    png.reserve((8 /* preamble */) + (12 + 13 /* IHDR */) + (12 + plte.size() /* PLTE */) +
+                (12 + trns.size() /* tRNS */) + (12 + idat.size() /* IDAT */) + (12 /* IEND */));
     png.append(preamble, 8);
     addChunk(png, "IHDR", ihdr, 13);
+    if (!plte.empty()) {
+        addChunk(png, "PLTE", plte.data(), static_cast<uint32_t>(plte.size()));
+    }
+    if (!trns.empty()) {
+        addChunk(png, "tRNS", trns.data(), static_cast<uint32_t>(trns.size()));
+    }
     addChunk(png, "IDAT", idat.data(), static_cast<uint32_t>(idat.size()));
     addChunk(png, "IEND");
     return png;
 }
 
+// Same rounding as util::unpremultiply. Fully transparent pixels become
+// transparent black, which filters and compresses better.
+void unpremultiplyRow(const uint8_t* src, uint8_t* dst, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; i += 4) {
+        const uint8_t a = src[i + 3];
+        if (a == 255) {
+            std::memcpy(dst + i, src + i, 4);
+        } else if (a == 0) {
+            std::memset(dst + i, 0, 4);
+        } else {
+            dst[i + 0] = (255 * src[i + 0] + (a / 2)) / a;
+            dst[i + 1] = (255 * src[i + 1] + (a / 2)) / a;
+            dst[i + 2] = (255 * src[i + 2] + (a / 2)) / a;
+            dst[i + 3] = a;
+        }
+    }
+}
+
+uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+    const int p = int(a) + int(b) - int(c);
+    const int pa = std::abs(p - int(a));
+    const int pb = std::abs(p - int(b));
+    const int pc = std::abs(p - int(c));
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+constexpr std::size_t bpp = 4;
+
+// Writes the filtered scanline to out and returns an estimate of its cost
+// after deflate. The usual estimate, the sum of the filtered bytes taken as
+// signed values, favors filtering the flat areas of rendered tiles, which
+// deflate handles just as well unfiltered. Instead, count where the bytes stop
+// repeating the previous pixel, plus a fraction of their magnitude.
+template <mbgl::PNGEncoder::Filter filter>
+uint32_t filterRow(const uint8_t* cur, const uint8_t* prev, uint8_t* out, std::size_t bytes) {
+    using Filter = mbgl::PNGEncoder::Filter;
+    uint32_t sum = 0;
+    for (std::size_t i = 0; i < bytes; i++) {
+        const uint8_t left = i >= bpp ? cur[i - bpp] : 0;
+        const uint8_t up = prev[i];
+        const uint8_t upLeft = i >= bpp ? prev[i - bpp] : 0;
+        uint8_t value;
+        switch (filter) {
+        case Filter::Sub: value = cur[i] - left; break;
+        case Filter::Up: value = cur[i] - up; break;
+        case Filter::Paeth: value = cur[i] - paeth(left, up, upLeft); break;
+        default: value = cur[i]; break;
+        }
+        out[i] = value;
+        if (i < bpp || value != out[i - bpp]) {
+            sum += 1 + (value < 128 ? value : 256 - value) / 16;
+        }
+    }
+    return sum;
+}
+
+struct Color {
+    uint32_t r = 0, g = 0, b = 0, a = 0;
+};
+
+uint32_t pack(const uint8_t* p) {
+    return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | uint32_t(p[3]);
+}
+
+// The quantization bucket of a color: its top four bits per channel.
+uint16_t bucket(const uint8_t* p) {
+    return uint16_t((p[0] >> 4) << 12 | (p[1] >> 4) << 8 | (p[2] >> 4) << 4 | (p[3] >> 4));
+}
+
+} // namespace
+
+namespace mbgl {
+
+PNGEncoder::PNGEncoder() : PNGEncoder(Options()) {
+}
+
+PNGEncoder::PNGEncoder(Options options_) : options(std::move(options_)) {
+}
+
+std::string PNGEncoder::encode(const PremultipliedImage& pre) {
+    return options.palette ? encodePalette(pre) : encodeTruecolor(pre);
+}
+
+std::string PNGEncoder::encodeTruecolor(const PremultipliedImage& pre) {
+    const std::size_t stride = pre.stride();
+    const bool adaptive = options.filter == Filter::Adaptive;
+
+    // Only the current and the previous unpremultiplied scanline are kept.
+    rows.assign(2 * stride, 0);
+    candidates.resize(adaptive ? 4 * stride : stride);
+    idat.clear();
+    idat.reserve(pre.size.height * (stride + 1));
+
+    for (uint32_t y = 0; y < pre.size.height; y++) {
+        uint8_t* cur = rows.data() + (y % 2) * stride;
+        const uint8_t* prev = rows.data() + ((y + 1) % 2) * stride;
+        unpremultiplyRow(pre.data.get() + y * stride, cur, stride);
+
+        Filter filter = options.filter;
+        const uint8_t* filtered = candidates.data();
+        if (adaptive) {
+            const std::array<Filter, 4> filters = {{ Filter::None, Filter::Sub, Filter::Up, Filter::Paeth }};
+            const std::array<uint32_t, 4> sums = {{
+                filterRow<Filter::None>(cur, prev, candidates.data(), stride),
+                filterRow<Filter::Sub>(cur, prev, candidates.data() + stride, stride),
+                filterRow<Filter::Up>(cur, prev, candidates.data() + 2 * stride, stride),
+                filterRow<Filter::Paeth>(cur, prev, candidates.data() + 3 * stride, stride),
+            }};
+            const std::size_t best = std::min_element(sums.begin(), sums.end()) - sums.begin();
+            filter = filters[best];
+            filtered = candidates.data() + best * stride;
+        } else {
+            switch (filter) {
+            case Filter::Sub: filterRow<Filter::Sub>(cur, prev, candidates.data(), stride); break;
+            case Filter::Up: filterRow<Filter::Up>(cur, prev, candidates.data(), stride); break;
+            case Filter::Paeth: filterRow<Filter::Paeth>(cur, prev, candidates.data(), stride); break;
+            default: filtered = cur; break;
+            }
+        }
+
+        // Every scanline needs to be prefixed with one byte that indicates the filter type.
+        idat.append(1, char(filter));
+        idat.append(reinterpret_cast<const char*>(filtered), stride);
+    }
+
+    return assemblePNG(pre.size, 6 /* RGBA */, util::compress(idat, options.level));
+}
+
+std::string PNGEncoder::encodePalette(const PremultipliedImage& pre) {
+    const std::size_t pixels = pre.size.width * pre.size.height;
+
+    // Unpremultiply the whole image; the palette depends on all of it.
+    rows.resize(pre.bytes());
+    for (uint32_t y = 0; y < pre.size.height; y++) {
+        unpremultiplyRow(pre.data.get() + y * pre.stride(), rows.data() + y * pre.stride(), pre.stride());
+    }
+
+    std::vector<Color> palette;
+    std::unordered_map<uint32_t, uint8_t> exact;
+    for (std::size_t i = 0; i < pixels && exact.size() <= 256; i++) {
+        const uint32_t color = pack(rows.data() + 4 * i);
+        if (exact.find(color) == exact.end()) {
+            exact.emplace(color, uint8_t(exact.size()));
+            Color c;
+            c.r = rows[4 * i + 0]; c.g = rows[4 * i + 1]; c.b = rows[4 * i + 2]; c.a = rows[4 * i + 3];
+            palette.push_back(c);
+        }
+    }
+
+    // With too many colors, take the average colors of the 256 most
+    // populated buckets, and map every bucket to its nearest palette entry.
+    std::vector<uint8_t> lookup;
+    const bool quantized = exact.size() > 256;
+    if (quantized) {
+        std::vector<Color> sums(1 << 16);
+        std::vector<uint32_t> counts(1 << 16, 0);
+        for (std::size_t i = 0; i < pixels; i++) {
+            const uint8_t* p = rows.data() + 4 * i;
+            const uint16_t b = bucket(p);
+            sums[b].r += p[0]; sums[b].g += p[1]; sums[b].b += p[2]; sums[b].a += p[3];
+            counts[b]++;
+        }
+
+        std::vector<uint16_t> used;
+        for (uint32_t b = 0; b < counts.size(); b++) {
+            if (counts[b]) {
+                used.push_back(uint16_t(b));
+            }
+        }
+        std::sort(used.begin(), used.end(), [&] (uint16_t l, uint16_t r) {
+            return counts[l] > counts[r];
+        });
+
+        palette.clear();
+        for (std::size_t i = 0; i < used.size() && i < 256; i++) {
+            const uint16_t b = used[i];
+            Color c;
+            c.r = (sums[b].r + counts[b] / 2) / counts[b];
+            c.g = (sums[b].g + counts[b] / 2) / counts[b];
+            c.b = (sums[b].b + counts[b] / 2) / counts[b];
+            c.a = (sums[b].a + counts[b] / 2) / counts[b];
+            palette.push_back(c);
+        }
+
+        lookup.assign(1 << 16, 0);
+        for (const uint16_t b : used) {
+            const Color& avg = sums[b];
+            const int r = avg.r / counts[b], g = avg.g / counts[b], bl = avg.b / counts[b], a = avg.a / counts[b];
+            uint32_t bestDistance = UINT32_MAX;
+            for (std::size_t i = 0; i < palette.size(); i++) {
+                const int dr = int(palette[i].r) - r, dg = int(palette[i].g) - g;
+                const int db = int(palette[i].b) - bl, da = int(palette[i].a) - a;
+                const uint32_t distance = dr * dr + dg * dg + db * db + 2 * da * da;
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    lookup[b] = uint8_t(i);
+                }
+            }
+        }
+    }
+
+    // Translucent entries go first, so the tRNS chunk can stop at the last one.
+    std::vector<uint8_t> order(palette.size());
+    for (std::size_t i = 0; i < order.size(); i++) {
+        order[i] = uint8_t(i);
+    }
+    std::stable_partition(order.begin(), order.end(), [&] (uint8_t i) {
+        return palette[i].a < 255;
+    });
+    std::array<uint8_t, 256> remap;
+    std::string plte, trns;
+    for (std::size_t i = 0; i < order.size(); i++) {
+        const Color& c = palette[order[i]];
+        remap[order[i]] = uint8_t(i);
+        plte.append({ char(c.r), char(c.g), char(c.b) });
+        if (c.a < 255) {
+            trns.append(1, char(c.a));
+        }
+    }
+
+    // Palette images compress best unfiltered.
+    idat.clear();
+    idat.reserve(pre.size.height * (pre.size.width + 1));
+    for (uint32_t y = 0; y < pre.size.height; y++) {
+        idat.append(1, char(Filter::None));
+        for (uint32_t x = 0; x < pre.size.width; x++) {
+            const uint8_t* p = rows.data() + y * pre.stride() + 4 * x;
+            const uint8_t index = quantized ? lookup[bucket(p)] : exact[pack(p)];
+            idat.append(1, char(remap[index]));
+        }
+    }
+
+    return assemblePNG(pre.size, 3 /* palette */, util::compress(idat, options.level), plte, trns);
+}
+
+// Encode PNGs without libpng.
+std::string encodePNG(const PremultipliedImage& pre) {
+    return PNGEncoder().encode(pre);
+}
+
 } // namespace mbgl
@@ -1,8 +1,10 @@
 #include <mbgl/util/thread_local.hpp>
 
+#include <mbgl/actor/message_pool.hpp>
 #include <mbgl/renderer/backend_scope.hpp>
 #include <mbgl/util/logging.hpp>
 #include <mbgl/util/run_loop.hpp>
+#include <mbgl/util/work_stealing_thread_pool.hpp>
 
 #include <stdexcept>
 #include <cassert>
@@ -60,6 +62,8 @@ void ThreadLocal<T>::set(T* ptr) {
 
 template class ThreadLocal<BackendScope>;
 template class ThreadLocal<Scheduler>;
+template class ThreadLocal<WorkStealingThreadPool::Worker>;
+template class ThreadLocal<MessagePool>;
 template class ThreadLocal<int>; // For unit tests
 
 } // namespace util
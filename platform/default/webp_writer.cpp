@@ -0,0 +1,34 @@
+#include <mbgl/util/image.hpp>
+#include <mbgl/util/premultiply.hpp>
+
+#include <cstdlib>
+#include <stdexcept>
+
+extern "C"
+{
+#include <webp/encode.h>
+}
+
+namespace mbgl {
+
+std::string encodeWebP(const PremultipliedImage& pre, int quality, bool lossless) {
+    const auto src = util::unpremultiply(pre.clone());
+
+    const int width = static_cast<int>(src.size.width);
+    const int height = static_cast<int>(src.size.height);
+    const int stride = static_cast<int>(src.stride());
+
+    uint8_t* output = nullptr;
+    const size_t size = lossless
+        ? WebPEncodeLosslessRGBA(src.data.get(), width, height, stride, &output)
+        : WebPEncodeRGBA(src.data.get(), width, height, stride, quality, &output);
+    if (size == 0) {
+        throw std::runtime_error("failed to encode WebP data");
+    }
+
+    std::string webp(reinterpret_cast<const char*>(output), size);
+    free(output);
+    return webp;
+}
+
+} // namespace mbgl
@@ -53,9 +53,11 @@ macro(mbgl_platform_core)
         # Image handling
         PRIVATE platform/default/image.cpp
         PRIVATE platform/default/jpeg_reader.cpp
+        PRIVATE platform/default/jpeg_writer.cpp
         PRIVATE platform/default/png_writer.cpp
         PRIVATE platform/default/png_reader.cpp
         PRIVATE platform/default/webp_reader.cpp
+        PRIVATE platform/default/webp_writer.cpp
 
         # Headless view
         PRIVATE platform/default/mbgl/gl/headless_frontend.cpp
@@ -66,6 +68,8 @@ macro(mbgl_platform_core)
         # Thread pool
         PRIVATE platform/default/mbgl/util/default_thread_pool.cpp
         PRIVATE platform/default/mbgl/util/default_thread_pool.cpp
+        PRIVATE platform/default/mbgl/util/work_stealing_thread_pool.cpp
+        PRIVATE platform/default/mbgl/util/work_stealing_thread_pool.hpp
         PRIVATE platform/default/mbgl/util/shared_thread_pool.cpp
     )
 
@@ -5,6 +5,7 @@
 #include <EGL/egl.h>
 
 #include <cassert>
+#include <mutex>
 
 namespace mbgl {
 
@@ -53,6 +54,10 @@ public:
     }
 
     static std::shared_ptr<const EGLDisplayConfig> create() {
+        // create() may race from several render threads.
+        static std::mutex mutex;
+        std::lock_guard<std::mutex> lock(mutex);
+
         static std::weak_ptr<const EGLDisplayConfig> instance;
         auto shared = instance.lock();
         if (!shared) {
@@ -69,6 +74,14 @@ public:
 class EGLBackendImpl : public HeadlessBackend::Impl {
 public:
     EGLBackendImpl() {
+        // The bound API is per-thread state, so it must be set on the thread that
+        // creates the context, not just the one that initialized the display.
+        if (!eglBindAPI(EGL_OPENGL_ES_API)) {
+            mbgl::Log::Error(mbgl::Event::OpenGL, "eglBindAPI(EGL_OPENGL_ES_API) returned error %d",
+                             eglGetError());
+            throw std::runtime_error("eglBindAPI() failed");
+        }
+
         // EGL initializes the context client version to 1 by default. We want to
         // use OpenGL ES 2.0 which has the ability to create shader and program
         // objects and also to write vertex and fragment shaders in the OpenGL ES
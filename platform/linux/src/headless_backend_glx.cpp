@@ -3,6 +3,7 @@
 #include <mbgl/util/logging.hpp>
 
 #include <cassert>
+#include <mutex>
 
 #include <GL/glx.h>
 
@@ -57,6 +58,10 @@ public:
     }
 
     static std::shared_ptr<const GLXDisplayConfig> create() {
+        // XOpenDisplay isn't reentrant, and render threads create backends concurrently.
+        static std::mutex mutex;
+        std::lock_guard<std::mutex> lock(mutex);
+
         static std::weak_ptr<const GLXDisplayConfig> instance;
         auto shared = instance.lock();
         if (!shared) {
@@ -18,7 +18,7 @@ NodeThreadPool::~NodeThreadPool() {
     queue->stop();
 }
 
-void NodeThreadPool::schedule(std::weak_ptr<mbgl::Mailbox> mailbox) {
+void NodeThreadPool::schedule(std::weak_ptr<mbgl::Mailbox> mailbox, Priority) {
     queue->send(std::move(mailbox));
 }
 
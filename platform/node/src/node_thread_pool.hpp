@@ -17,7 +17,7 @@ public:
     NodeThreadPool();
     ~NodeThreadPool();
 
-    void schedule(std::weak_ptr<mbgl::Mailbox>) override;
+    void schedule(std::weak_ptr<mbgl::Mailbox>, Priority) override;
 
 private:
     util::AsyncQueue<std::weak_ptr<mbgl::Mailbox>>* queue;
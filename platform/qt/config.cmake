@@ -31,8 +31,10 @@ macro(mbgl_platform_core)
     if(NOT WITH_QT_DECODERS)
         target_sources(mbgl-core
             PRIVATE platform/default/jpeg_reader.cpp
+            PRIVATE platform/default/jpeg_writer.cpp
             PRIVATE platform/default/png_reader.cpp
             PRIVATE platform/default/webp_reader.cpp
+            PRIVATE platform/default/webp_writer.cpp
         )
 
         target_add_mason_package(mbgl-core PRIVATE libjpeg-turbo)
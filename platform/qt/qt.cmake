@@ -23,6 +23,8 @@ set(MBGL_QT_CORE_FILES
     PRIVATE platform/default/mbgl/util/shared_thread_pool.hpp
     PRIVATE platform/default/mbgl/util/default_thread_pool.cpp
     PRIVATE platform/default/mbgl/util/default_thread_pool.hpp
+    PRIVATE platform/default/mbgl/util/work_stealing_thread_pool.cpp
+    PRIVATE platform/default/mbgl/util/work_stealing_thread_pool.hpp
 
     # Thread
     PRIVATE platform/qt/src/thread_local.cpp
@@ -1,7 +1,9 @@
 #include <mbgl/util/thread_local.hpp>
 
+#include <mbgl/actor/message_pool.hpp>
 #include <mbgl/actor/scheduler.hpp>
 #include <mbgl/renderer/backend_scope.hpp>
+#include <mbgl/util/work_stealing_thread_pool.hpp>
 
 #include <array>
 #include <cassert>
@@ -43,6 +45,8 @@ void ThreadLocal<T>::set(T* ptr) {
 
 template class ThreadLocal<Scheduler>;
 template class ThreadLocal<BackendScope>;
+template class ThreadLocal<WorkStealingThreadPool::Worker>;
+template class ThreadLocal<MessagePool>;
 template class ThreadLocal<int>; // For unit tests
 
 } // namespace util
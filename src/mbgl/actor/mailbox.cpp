@@ -6,60 +6,147 @@
 
 namespace mbgl {
 
+namespace {
+
+// Keeps the queue non-empty, so that senders never touch `tail`.
+class StubMessage : public Message {
+public:
+    void operator()() override {
+        assert(false);
+    }
+};
+
+} // namespace
+
 Mailbox::Mailbox(Scheduler& scheduler_)
-    : scheduler(scheduler_) {
+    : scheduler(scheduler_),
+      stub(std::make_unique<StubMessage>()),
+      head(stub.get()),
+      tail(stub.get()) {
 }
 
-void Mailbox::close() {
-    // Block until neither receive() nor push() are in progress. Two mutexes are used because receive()
-    // must not block send(). Of the two, the receiving mutex must be acquired first, because that is
-    // the order that an actor will obtain them when it self-sends a message, and consistent lock
-    // acquisition order prevents deadlocks.
-    // The receiving mutex is recursive to allow a mailbox (and thus the actor) to close itself.
-    std::lock_guard<std::recursive_mutex> receivingLock(receivingMutex);
-    std::lock_guard<std::mutex> pushingLock(pushingMutex);
+Mailbox::~Mailbox() {
+    // Nobody can be sending to us any more, so the queue is consistent.
+    while (Message* message = dequeue()) {
+        delete message;
+    }
+}
 
+void Mailbox::close() {
+    // Block until neither receive() nor push() are in progress. Both announce themselves before
+    // they check `closed`, so once it's set we only have to wait for those that already have.
+    // A mailbox (and thus the actor) may close itself from within receive(), in which case we
+    // mustn't wait for ourselves.
     closed = true;
+
+    while (pushing != 0) {
+        std::this_thread::yield();
+    }
+
+    if (receiving == std::this_thread::get_id()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(closingMutex);
+    receiveDone.wait(lock, [this] { return receiving.load() == std::thread::id(); });
 }
 
 void Mailbox::push(std::unique_ptr<Message> message) {
-    std::lock_guard<std::mutex> pushingLock(pushingMutex);
+    pushing++;
 
     if (closed) {
+        pushing--;
         return;
     }
 
-    std::lock_guard<std::mutex> queueLock(queueMutex);
-    bool wasEmpty = queue.empty();
-    queue.push(std::move(message));
-    if (wasEmpty) {
-        scheduler.schedule(shared_from_this());
+    enqueue(message.release());
+
+    // Whoever finds the mailbox empty schedules it; receive() reschedules it
+    // while it isn't, so it's only ever scheduled once at a time.
+    if (size++ == 0) {
+        scheduler.schedule(shared_from_this(), priority.load(std::memory_order_relaxed));
     }
+
+    pushing--;
+}
+
+void Mailbox::setPriority(Scheduler::Priority priority_) {
+    priority.store(priority_, std::memory_order_relaxed);
 }
 
 void Mailbox::receive() {
-    std::lock_guard<std::recursive_mutex> receivingLock(receivingMutex);
+    const std::thread::id self = std::this_thread::get_id();
+    receiving = self;
 
     if (closed) {
+        doneReceiving(self);
         return;
     }
 
-    std::unique_ptr<Message> message;
-    bool wasEmpty;
-
-    {
-        std::lock_guard<std::mutex> queueLock(queueMutex);
-        assert(!queue.empty());
-        message = std::move(queue.front());
-        queue.pop();
-        wasEmpty = queue.empty();
+    Message* message;
+    while (!(message = dequeue())) {
+        // A sender has counted its message but not linked it yet.
+        std::this_thread::yield();
     }
 
     (*message)();
+    delete message;
 
-    if (!wasEmpty) {
-        scheduler.schedule(shared_from_this());
+    if (size-- > 1 && !closed) {
+        scheduler.schedule(shared_from_this(), priority.load(std::memory_order_relaxed));
     }
+
+    doneReceiving(self);
+}
+
+void Mailbox::doneReceiving(std::thread::id self) {
+    // The next receive() may already have started on another thread.
+    receiving.compare_exchange_strong(self, std::thread::id());
+
+    if (closed) {
+        std::lock_guard<std::mutex> lock(closingMutex);
+        receiveDone.notify_all();
+    }
+}
+
+void Mailbox::enqueue(Message* message) {
+    message->next.store(nullptr, std::memory_order_relaxed);
+    Message* previous = head.exchange(message, std::memory_order_acq_rel);
+    previous->next.store(message, std::memory_order_release);
+}
+
+Message* Mailbox::dequeue() {
+    Message* first = tail;
+    Message* next = first->next.load(std::memory_order_acquire);
+
+    if (first == stub.get()) {
+        if (!next) {
+            return nullptr;
+        }
+        tail = next;
+        first = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next) {
+        tail = next;
+        return first;
+    }
+
+    if (first != head.load(std::memory_order_acquire)) {
+        // A sender is between swapping `head` and linking its message.
+        return nullptr;
+    }
+
+    // `first` is the last message; put the stub behind it so we can take it.
+    enqueue(stub.get());
+    next = first->next.load(std::memory_order_acquire);
+    if (next) {
+        tail = next;
+        return first;
+    }
+
+    return nullptr;
 }
 
 void Mailbox::maybeReceive(std::weak_ptr<Mailbox> mailbox) {
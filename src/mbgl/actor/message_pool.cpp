@@ -0,0 +1,84 @@
+#include <mbgl/actor/message_pool.hpp>
+#include <mbgl/util/thread_local.hpp>
+
+#include <cassert>
+#include <new>
+
+namespace mbgl {
+
+namespace {
+
+// Size classes are 64, 128, 256 and 512 bytes.
+constexpr std::size_t smallestClass = 64;
+
+// How many free blocks a pool keeps per size class.
+constexpr std::size_t blocksPerClass = 256;
+
+auto& current() {
+    static util::ThreadLocal<MessagePool> pool;
+    return pool;
+}
+
+std::size_t sizeClass(std::size_t size) {
+    std::size_t index = 0;
+    for (std::size_t capacity = smallestClass; capacity < size; capacity *= 2) {
+        ++index;
+    }
+    return index;
+}
+
+} // namespace
+
+constexpr std::size_t MessagePool::classCount;
+
+MessagePool::MessagePool()
+    : previous(current().get()) {
+    current().set(this);
+}
+
+MessagePool::~MessagePool() {
+    assert(current().get() == this);
+    current().set(previous);
+
+    for (Block* block : blocks) {
+        while (block) {
+            Block* next = block->next;
+            ::operator delete(block);
+            block = next;
+        }
+    }
+}
+
+void* MessagePool::allocate(std::size_t size) {
+    const std::size_t index = sizeClass(size);
+    if (index >= classCount) {
+        return ::operator new(size);
+    }
+
+    MessagePool* pool = current().get();
+    if (pool && pool->blocks[index]) {
+        Block* block = pool->blocks[index];
+        pool->blocks[index] = block->next;
+        pool->counts[index]--;
+        return block;
+    }
+
+    // Blocks are always as large as their class, so that any pool can reuse them.
+    return ::operator new(smallestClass << index);
+}
+
+void MessagePool::deallocate(void* ptr, std::size_t size) {
+    const std::size_t index = sizeClass(size);
+
+    MessagePool* pool = index < classCount ? current().get() : nullptr;
+    if (!pool || pool->counts[index] == blocksPerClass) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    Block* block = new (ptr) Block { pool->blocks[index] };
+    pool->blocks[index] = block;
+    pool->counts[index]++;
+}
+
+} // namespace mbgl
@@ -2,6 +2,8 @@
 #include <mbgl/util/thread_local.hpp>
 
 namespace mbgl {
+
+constexpr Scheduler::Priority Scheduler::defaultPriority;
     
 static auto& current() {
     static util::ThreadLocal<Scheduler> scheduler;
@@ -2,7 +2,7 @@
 #include <mbgl/layout/merge_lines.hpp>
 #include <mbgl/layout/clip_lines.hpp>
 #include <mbgl/renderer/buckets/symbol_bucket.hpp>
-#include <mbgl/style/filter_evaluator.hpp>
+#include <mbgl/style/compiled_filter.hpp>
 #include <mbgl/renderer/bucket_parameters.hpp>
 #include <mbgl/renderer/layers/render_symbol_layer.hpp>
 #include <mbgl/renderer/image_atlas.hpp>
@@ -98,9 +98,11 @@ SymbolLayout::SymbolLayout(const BucketParameters& parameters,
 
     // Determine glyph dependencies
     const size_t featureCount = sourceLayer->featureCount();
+    const CompiledFilter filter(leader.filter);
+    GeometryTileLayerKeys keys(*sourceLayer);
     for (size_t i = 0; i < featureCount; ++i) {
         auto feature = sourceLayer->getFeature(i);
-        if (!leader.filter(feature->getType(), feature->getID(), [&] (const auto& key) { return feature->getValue(key); }))
+        if (!filter(feature->getType(), feature->getID(), [&] (const auto& key) { return keys.getValue(*feature, key); }))
             continue;
         
         SymbolFeature ft(std::move(feature));
@@ -6,6 +6,7 @@
 #include <mbgl/renderer/query.hpp>
 #include <mbgl/map/transform.hpp>
 #include <mbgl/math/clamp.hpp>
+#include <mbgl/util/tile_coordinate.hpp>
 #include <mbgl/util/tile_cover.hpp>
 #include <mbgl/util/enum.hpp>
 #include <mbgl/util/logging.hpp>
@@ -15,6 +16,7 @@
 #include <mapbox/geometry/envelope.hpp>
 
 #include <algorithm>
+#include <cmath>
 
 namespace mbgl {
 
@@ -22,6 +24,17 @@ using namespace style;
 
 static TileObserver nullObserver;
 
+// Tiles nearest the centre of the viewport are laid out first, and prefetched tiles
+// only once all the others have been.
+static Scheduler::Priority tilePriority(const TileCoordinate& centre, const OverscaledTileID& id, bool prefetch) {
+    const TileCoordinate zoomed = centre.zoomTo(id.canonical.z);
+    const double dx = zoomed.p.x - (id.canonical.x + 0.5 + id.wrap * std::pow(2.0, id.canonical.z));
+    const double dy = zoomed.p.y - (id.canonical.y + 0.5);
+    // In sixteenths of a tile, after the default priority.
+    const double distance = util::clamp(std::sqrt(dx * dx + dy * dy) * 16, 0.0, double(0xFFFF));
+    return 1 + Scheduler::Priority(distance) + (prefetch ? 0x10000 : 0);
+}
+
 TilePyramid::TilePyramid()
     : observer(&nullObserver) {
 }
@@ -121,11 +134,17 @@ void TilePyramid::update(const std::vector<Immutable<style::Layer::Impl>>& layer
     std::set<OverscaledTileID> retain;
     std::set<UnwrappedTileID> rendered;
 
+    const TileCoordinate centre = TileCoordinate::fromLatLng(0, parameters.transformState.getLatLng());
+    bool prefetching = false;
+
     auto retainTileFn = [&](Tile& tile, TileNecessity necessity) -> void {
         if (retain.emplace(tile.id).second) {
             tile.setNecessity(necessity);
         }
 
+        // Tiles retained by both passes end up with the priority of the ideal one.
+        tile.setPriority(tilePriority(centre, tile.id, prefetching));
+
         if (needsRelayout) {
             tile.setLayers(layers);
         }
@@ -139,6 +158,7 @@ void TilePyramid::update(const std::vector<Immutable<style::Layer::Impl>>& layer
         if (!tile) {
             tile = createTile(tileID);
             if (tile) {
+                tile->setPriority(tilePriority(centre, tileID, prefetching));
                 tile->setObserver(observer);
                 tile->setLayers(layers);
             }
@@ -164,8 +184,10 @@ void TilePyramid::update(const std::vector<Immutable<style::Layer::Impl>>& layer
     renderTiles.clear();
 
     if (!panTiles.empty()) {
+        prefetching = true;
         algorithm::updateRenderables(getTileFn, createTileFn, retainTileFn,
                 [](const UnwrappedTileID&, Tile&) {}, panTiles, zoomRange, panZoom);
+        prefetching = false;
     }
 
     algorithm::updateRenderables(getTileFn, createTileFn, retainTileFn, renderTileFn,
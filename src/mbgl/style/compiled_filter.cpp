@@ -0,0 +1,248 @@
+#include <mbgl/style/compiled_filter.hpp>
+
+namespace mbgl {
+namespace style {
+
+namespace {
+
+// -0.0 and 0.0 compare equal, so they must hash alike.
+double normalize(double number) {
+    return number == 0 ? 0.0 : number;
+}
+
+} // namespace
+
+constexpr std::size_t CompiledFilter::ValueSet::hashThreshold;
+constexpr std::size_t CompiledFilter::localKeys;
+
+CompiledFilter::ValueSet::ValueSet(std::vector<Value> values_)
+    : values(std::move(values_)),
+      hashed(values.size() > hashThreshold) {
+    if (!hashed) {
+        return;
+    }
+    for (const auto& value : values) {
+        if (value.is<std::string>()) {
+            strings.insert(value.get<std::string>());
+        } else if (value.is<bool>()) {
+            (value.get<bool>() ? hasTrue : hasFalse) = true;
+        } else if (value.is<uint64_t>()) {
+            uints.insert(value.get<uint64_t>());
+            uintDoubles.insert(double(value.get<uint64_t>()));
+        } else if (value.is<int64_t>()) {
+            ints.insert(value.get<int64_t>());
+            intDoubles.insert(double(value.get<int64_t>()));
+        } else if (value.is<double>()) {
+            doubles.insert(normalize(value.get<double>()));
+        }
+        // Null and nested values never match.
+    }
+}
+
+bool CompiledFilter::ValueSet::contains(const Value& actual) const {
+    if (!hashed) {
+        for (const auto& value : values) {
+            if (detail::equal(actual, value)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (actual.is<std::string>()) {
+        return strings.count(actual.get<std::string>()) != 0;
+    } else if (actual.is<bool>()) {
+        return actual.get<bool>() ? hasTrue : hasFalse;
+    } else if (actual.is<uint64_t>()) {
+        const uint64_t number = actual.get<uint64_t>();
+        return uints.count(number) != 0 || doubles.count(double(number)) != 0 ||
+            intDoubles.count(double(number)) != 0;
+    } else if (actual.is<int64_t>()) {
+        const int64_t number = actual.get<int64_t>();
+        return ints.count(number) != 0 || doubles.count(double(number)) != 0 ||
+            uintDoubles.count(double(number)) != 0;
+    } else if (actual.is<double>()) {
+        const double number = normalize(actual.get<double>());
+        return doubles.count(number) != 0 || intDoubles.count(number) != 0 ||
+            uintDoubles.count(number) != 0;
+    }
+    return false;
+}
+
+class CompiledFilter::Compiler {
+public:
+    CompiledFilter& compiled;
+
+    void operator()(const NullFilter&) {
+        emit(Op::True);
+    }
+
+    void operator()(const EqualsFilter& filter) {
+        emit(Op::In, key(filter.key), valueSet({ filter.value }));
+    }
+
+    void operator()(const NotEqualsFilter& filter) {
+        emit(Op::In, key(filter.key), valueSet({ filter.value }));
+        emit(Op::Not);
+    }
+
+    void operator()(const LessThanFilter& filter) {
+        emit(Op::LessThan, key(filter.key), value(filter.value));
+    }
+
+    void operator()(const LessThanEqualsFilter& filter) {
+        emit(Op::LessThanEquals, key(filter.key), value(filter.value));
+    }
+
+    void operator()(const GreaterThanFilter& filter) {
+        emit(Op::GreaterThan, key(filter.key), value(filter.value));
+    }
+
+    void operator()(const GreaterThanEqualsFilter& filter) {
+        emit(Op::GreaterThanEquals, key(filter.key), value(filter.value));
+    }
+
+    void operator()(const InFilter& filter) {
+        emit(Op::In, key(filter.key), valueSet(filter.values));
+    }
+
+    void operator()(const NotInFilter& filter) {
+        emit(Op::In, key(filter.key), valueSet(filter.values));
+        emit(Op::Not);
+    }
+
+    void operator()(const AnyFilter& filter) {
+        sequence(filter.filters, Op::JumpIfTrue, Op::False);
+    }
+
+    void operator()(const AllFilter& filter) {
+        sequence(filter.filters, Op::JumpIfFalse, Op::True);
+    }
+
+    void operator()(const NoneFilter& filter) {
+        sequence(filter.filters, Op::JumpIfTrue, Op::False);
+        emit(Op::Not);
+    }
+
+    void operator()(const HasFilter& filter) {
+        emit(Op::Has, key(filter.key));
+    }
+
+    void operator()(const NotHasFilter& filter) {
+        emit(Op::Has, key(filter.key));
+        emit(Op::Not);
+    }
+
+    void operator()(const TypeEqualsFilter& filter) {
+        emit(Op::TypeIn, typeMask({ filter.value }));
+    }
+
+    void operator()(const TypeNotEqualsFilter& filter) {
+        emit(Op::TypeIn, typeMask({ filter.value }));
+        emit(Op::Not);
+    }
+
+    void operator()(const TypeInFilter& filter) {
+        emit(Op::TypeIn, typeMask(filter.values));
+    }
+
+    void operator()(const TypeNotInFilter& filter) {
+        emit(Op::TypeIn, typeMask(filter.values));
+        emit(Op::Not);
+    }
+
+    void operator()(const IdentifierEqualsFilter& filter) {
+        emit(Op::IdentifierIn, identifierSet({ filter.value }));
+    }
+
+    void operator()(const IdentifierNotEqualsFilter& filter) {
+        emit(Op::IdentifierIn, identifierSet({ filter.value }));
+        emit(Op::Not);
+    }
+
+    void operator()(const IdentifierInFilter& filter) {
+        emit(Op::IdentifierIn, identifierSet(filter.values));
+    }
+
+    void operator()(const IdentifierNotInFilter& filter) {
+        emit(Op::IdentifierIn, identifierSet(filter.values));
+        emit(Op::Not);
+    }
+
+    void operator()(const HasIdentifierFilter&) {
+        emit(Op::HasIdentifier);
+    }
+
+    void operator()(const NotHasIdentifierFilter&) {
+        emit(Op::HasIdentifier);
+        emit(Op::Not);
+    }
+
+private:
+    void emit(Op op, uint32_t a = 0, uint32_t b = 0) {
+        compiled.program.push_back({ op, a, b });
+    }
+
+    // Evaluates the filters in turn, and stops at the first one that gives
+    // the result `jump` looks for. An empty sequence gives `empty`.
+    void sequence(const std::vector<Filter>& filters, Op jump, Op empty) {
+        if (filters.empty()) {
+            emit(empty);
+            return;
+        }
+
+        std::vector<std::size_t> jumps;
+        for (std::size_t i = 0; i < filters.size(); ++i) {
+            Filter::visit(filters[i], *this);
+            if (i + 1 < filters.size()) {
+                jumps.push_back(compiled.program.size());
+                emit(jump);
+            }
+        }
+
+        for (std::size_t index : jumps) {
+            compiled.program[index].a = uint32_t(compiled.program.size());
+        }
+    }
+
+    uint32_t key(const std::string& key_) {
+        for (std::size_t i = 0; i < compiled.keys.size(); ++i) {
+            if (compiled.keys[i] == key_) {
+                return uint32_t(i);
+            }
+        }
+        compiled.keys.push_back(key_);
+        return uint32_t(compiled.keys.size() - 1);
+    }
+
+    uint32_t value(const Value& value_) {
+        compiled.values.push_back(value_);
+        return uint32_t(compiled.values.size() - 1);
+    }
+
+    uint32_t valueSet(std::vector<Value> values_) {
+        compiled.valueSets.emplace_back(std::move(values_));
+        return uint32_t(compiled.valueSets.size() - 1);
+    }
+
+    uint32_t identifierSet(std::vector<FeatureIdentifier> identifiers) {
+        compiled.identifierSets.push_back(std::move(identifiers));
+        return uint32_t(compiled.identifierSets.size() - 1);
+    }
+
+    static uint32_t typeMask(const std::vector<FeatureType>& types) {
+        uint32_t mask = 0;
+        for (FeatureType type : types) {
+            mask |= 1u << uint8_t(type);
+        }
+        return mask;
+    }
+};
+
+CompiledFilter::CompiledFilter(const Filter& filter) {
+    Compiler compiler { *this };
+    Filter::visit(filter, compiler);
+}
+
+} // namespace style
+} // namespace mbgl
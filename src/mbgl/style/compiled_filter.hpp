@@ -0,0 +1,197 @@
+#pragma once
+
+#include <mbgl/style/filter.hpp>
+#include <mbgl/style/filter_evaluator.hpp>
+#include <mbgl/util/geometry.hpp>
+#include <mbgl/util/optional.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace mbgl {
+namespace style {
+
+/*
+   A `Filter` compiled into a flat program, for filters that are evaluated
+   against many features, such as a layer's filter during tile layout.
+
+   Keys are interned when the filter is compiled, and each key is fetched at
+   most once per evaluation, however often the filter refers to it. `in`
+   filters with many values are matched through hash sets. The result is
+   always the same as that of `FilterEvaluator`:
+
+       const CompiledFilter compiled(filter);
+       for (const auto& feature : features) {
+           if (compiled(feature.getType(), feature.getID(), accessor)) {
+               // matches the filter
+           }
+       }
+*/
+class CompiledFilter {
+public:
+    explicit CompiledFilter(const Filter&);
+
+    template <class PropertyAccessor>
+    bool operator()(FeatureType, const optional<FeatureIdentifier>&, PropertyAccessor) const;
+
+private:
+    // Instructions operate on a single boolean result. Negated filters
+    // compile to their positive counterpart followed by `Not`, and `any`,
+    // `all` and `none` compile to conditional jumps past their remaining
+    // operands.
+    enum class Op : uint8_t {
+        True,
+        False,
+        Not,
+        JumpIfTrue,         // a: target
+        JumpIfFalse,        // a: target
+        Has,                // a: key
+        In,                 // a: key, b: value set
+        LessThan,           // a: key, b: value
+        LessThanEquals,     // a: key, b: value
+        GreaterThan,        // a: key, b: value
+        GreaterThanEquals,  // a: key, b: value
+        TypeIn,             // a: mask of feature types
+        IdentifierIn,       // a: identifier set
+        HasIdentifier,
+    };
+
+    struct Instruction {
+        Op op;
+        uint32_t a;
+        uint32_t b;
+    };
+
+    // The values of an `==` or `in` filter. Small sets are scanned; larger
+    // ones are hashed by type. As in the evaluator, numbers of the same type
+    // are compared exactly, and numbers of different types as doubles.
+    class ValueSet {
+    public:
+        explicit ValueSet(std::vector<Value>);
+
+        bool contains(const Value&) const;
+
+    private:
+        static constexpr std::size_t hashThreshold = 8;
+
+        std::vector<Value> values;
+        bool hashed;
+        std::unordered_set<std::string> strings;
+        std::unordered_set<int64_t> ints;
+        std::unordered_set<uint64_t> uints;
+        std::unordered_set<double> doubles;
+        // The integers as doubles, for numbers of the other types.
+        std::unordered_set<double> intDoubles;
+        std::unordered_set<double> uintDoubles;
+        bool hasTrue = false;
+        bool hasFalse = false;
+    };
+
+    // Evaluations keep the values they fetch on the stack for up to this
+    // many keys.
+    static constexpr std::size_t localKeys = 8;
+
+    class Compiler;
+
+    std::vector<Instruction> program;
+    std::vector<std::string> keys;
+    std::vector<Value> values;
+    std::vector<ValueSet> valueSets;
+    std::vector<std::vector<FeatureIdentifier>> identifierSets;
+};
+
+template <class PropertyAccessor>
+bool CompiledFilter::operator()(FeatureType type, const optional<FeatureIdentifier>& id, PropertyAccessor accessor) const {
+    std::array<optional<optional<Value>>, localKeys> local;
+    std::vector<optional<optional<Value>>> overflow;
+    optional<optional<Value>>* fetched = local.data();
+    if (keys.size() > local.size()) {
+        overflow.resize(keys.size());
+        fetched = overflow.data();
+    }
+
+    auto fetch = [&] (uint32_t key) -> const optional<Value>& {
+        if (!fetched[key]) {
+            fetched[key].emplace(accessor(keys[key]));
+        }
+        return *fetched[key];
+    };
+
+    bool result = true;
+    std::size_t pc = 0;
+    while (pc < program.size()) {
+        const Instruction& instruction = program[pc++];
+        switch (instruction.op) {
+        case Op::True:
+            result = true;
+            break;
+        case Op::False:
+            result = false;
+            break;
+        case Op::Not:
+            result = !result;
+            break;
+        case Op::JumpIfTrue:
+            if (result) {
+                pc = instruction.a;
+            }
+            break;
+        case Op::JumpIfFalse:
+            if (!result) {
+                pc = instruction.a;
+            }
+            break;
+        case Op::Has:
+            result = bool(fetch(instruction.a));
+            break;
+        case Op::In: {
+            const optional<Value>& actual = fetch(instruction.a);
+            result = actual && valueSets[instruction.b].contains(*actual);
+            break;
+        }
+        case Op::LessThan: {
+            const optional<Value>& actual = fetch(instruction.a);
+            result = actual && detail::compare(*actual, values[instruction.b], [] (const auto& lhs_, const auto& rhs_) { return lhs_ < rhs_; });
+            break;
+        }
+        case Op::LessThanEquals: {
+            const optional<Value>& actual = fetch(instruction.a);
+            result = actual && detail::compare(*actual, values[instruction.b], [] (const auto& lhs_, const auto& rhs_) { return lhs_ <= rhs_; });
+            break;
+        }
+        case Op::GreaterThan: {
+            const optional<Value>& actual = fetch(instruction.a);
+            result = actual && detail::compare(*actual, values[instruction.b], [] (const auto& lhs_, const auto& rhs_) { return lhs_ > rhs_; });
+            break;
+        }
+        case Op::GreaterThanEquals: {
+            const optional<Value>& actual = fetch(instruction.a);
+            result = actual && detail::compare(*actual, values[instruction.b], [] (const auto& lhs_, const auto& rhs_) { return lhs_ >= rhs_; });
+            break;
+        }
+        case Op::TypeIn:
+            result = (instruction.a & (1u << uint8_t(type))) != 0;
+            break;
+        case Op::IdentifierIn:
+            result = false;
+            for (const auto& v : identifierSets[instruction.a]) {
+                if (id == v) {
+                    result = true;
+                    break;
+                }
+            }
+            break;
+        case Op::HasIdentifier:
+            result = bool(id);
+            break;
+        }
+    }
+
+    return result;
+}
+
+} // namespace style
+} // namespace mbgl
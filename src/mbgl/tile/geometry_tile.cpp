@@ -124,6 +124,10 @@ void GeometryTile::setShowCollisionBoxes(const bool showCollisionBoxes_) {
     }
 }
 
+void GeometryTile::setPriority(Scheduler::Priority priority) {
+    worker.setPriority(priority);
+}
+
 void GeometryTile::onLayout(LayoutResult result, const uint64_t resultCorrelationID) {
     // Don't mark ourselves loaded or renderable until the first successful placement
     // TODO: Ideally we'd render this tile without symbols as long as this tile wasn't
@@ -36,6 +36,7 @@ public:
 
     void setLayers(const std::vector<Immutable<style::Layer::Impl>>&) override;
     void setShowCollisionBoxes(const bool showCollisionBoxes) override;
+    void setPriority(Scheduler::Priority) override;
 
     void onGlyphsAvailable(GlyphMap) override;
     void onImagesAvailable(ImageMap, uint64_t imageCorrelationID) override;
@@ -6,6 +6,8 @@
 
 #include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <memory>
 
@@ -39,9 +41,15 @@ public:
 
 class GeometryTileFeature {
 public:
+    // Identifies a property key within the layer the feature belongs to; see
+    // GeometryTileLayer::getKeyIDs.
+    using KeyID = uint32_t;
+
     virtual ~GeometryTileFeature() = default;
     virtual FeatureType getType() const = 0;
     virtual optional<Value> getValue(const std::string& key) const = 0;
+    // Only called for features of layers that have key IDs.
+    virtual optional<Value> getValueByID(KeyID) const { return {}; }
     virtual PropertyMap getProperties() const { return PropertyMap(); }
     virtual optional<FeatureIdentifier> getID() const { return {}; }
     virtual GeometryCollection getGeometries() const = 0;
@@ -57,6 +65,46 @@ public:
     virtual std::unique_ptr<GeometryTileFeature> getFeature(std::size_t) const = 0;
 
     virtual std::string getName() const = 0;
+
+    // Layers that keep a dictionary of their features' property keys return it, so that keys can
+    // be resolved once for all features. Keys that aren't in it aren't set on any feature.
+    virtual const std::unordered_map<std::string, GeometryTileFeature::KeyID>* getKeyIDs() const {
+        return nullptr;
+    }
+};
+
+// Looks up the properties of a layer's features by key ID where the layer has them, resolving
+// each key the first time it's asked for. Keep one per layer, for as long as its features are
+// filtered or evaluated: style layers only ask for a handful of keys, which are cheaper to find
+// in a short list than to hash.
+class GeometryTileLayerKeys {
+public:
+    explicit GeometryTileLayerKeys(const GeometryTileLayer& layer)
+        : keyIDs(layer.getKeyIDs()) {
+    }
+
+    optional<Value> getValue(const GeometryTileFeature& feature, const std::string& key) {
+        if (!keyIDs) {
+            return feature.getValue(key);
+        }
+        const optional<GeometryTileFeature::KeyID> id = resolve(key);
+        return id ? feature.getValueByID(*id) : optional<Value>();
+    }
+
+private:
+    optional<GeometryTileFeature::KeyID> resolve(const std::string& key) {
+        for (const auto& entry : resolved) {
+            if (entry.first == key) {
+                return entry.second;
+            }
+        }
+        auto it = keyIDs->find(key);
+        resolved.emplace_back(key, it != keyIDs->end() ? it->second : optional<GeometryTileFeature::KeyID>());
+        return resolved.back().second;
+    }
+
+    const std::unordered_map<std::string, GeometryTileFeature::KeyID>* keyIDs;
+    std::vector<std::pair<std::string, optional<GeometryTileFeature::KeyID>>> resolved;
 };
 
 class GeometryTileData {
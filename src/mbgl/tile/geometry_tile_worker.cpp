@@ -4,8 +4,7 @@
 #include <mbgl/layout/symbol_layout.hpp>
 #include <mbgl/renderer/bucket_parameters.hpp>
 #include <mbgl/renderer/group_by_layout.hpp>
-#include <mbgl/style/filter.hpp>
-#include <mbgl/style/filter_evaluator.hpp>
+#include <mbgl/style/compiled_filter.hpp>
 #include <mbgl/style/layers/symbol_layer_impl.hpp>
 #include <mbgl/renderer/layers/render_symbol_layer.hpp>
 #include <mbgl/renderer/buckets/symbol_bucket.hpp>
@@ -332,14 +331,15 @@ void GeometryTileWorker::redoLayout() {
             symbolLayoutMap.emplace(leader.getID(), std::move(layout));
             symbolLayoutsNeedPreparation = true;
         } else {
-            const Filter& filter = leader.baseImpl->filter;
+            const CompiledFilter filter(leader.baseImpl->filter);
             const std::string& sourceLayerID = leader.baseImpl->sourceLayer;
             std::shared_ptr<Bucket> bucket = leader.createBucket(parameters, group);
+            GeometryTileLayerKeys keys(*geometryLayer);
 
             for (std::size_t i = 0; !obsolete && i < geometryLayer->featureCount(); i++) {
                 std::unique_ptr<GeometryTileFeature> feature = geometryLayer->getFeature(i);
 
-                if (!filter(feature->getType(), feature->getID(), [&] (const auto& key) { return feature->getValue(key); }))
+                if (!filter(feature->getType(), feature->getID(), [&] (const auto& key) { return keys.getValue(*feature, key); }))
                     continue;
 
                 GeometryCollection geometries = feature->getGeometries();
@@ -81,4 +81,8 @@ void RasterTile::setNecessity(TileNecessity necessity) {
     loader.setNecessity(necessity);
 }
 
+void RasterTile::setPriority(Scheduler::Priority priority) {
+    worker.setPriority(priority);
+}
+
 } // namespace mbgl
@@ -23,6 +23,7 @@ public:
     ~RasterTile() final;
 
     void setNecessity(TileNecessity) final;
+    void setPriority(Scheduler::Priority) final;
 
     void setError(std::exception_ptr);
     void setMetadata(optional<Timestamp> modified, optional<Timestamp> expires);
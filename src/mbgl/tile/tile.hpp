@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mbgl/actor/scheduler.hpp>
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/chrono.hpp>
 #include <mbgl/util/optional.hpp>
@@ -42,6 +43,9 @@ public:
 
     virtual void setNecessity(TileNecessity) {}
 
+    // How urgently the tile's worker should be given a thread; see `Scheduler::Priority`.
+    virtual void setPriority(Scheduler::Priority) {}
+
     // Mark this tile as no longer needed and cancel any pending work.
     virtual void cancel() = 0;
 
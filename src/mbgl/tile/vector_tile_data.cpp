@@ -3,9 +3,54 @@
 
 namespace mbgl {
 
-VectorTileFeature::VectorTileFeature(const mapbox::vector_tile::layer& layer,
-                                     const protozero::data_view& view)
-    : feature(view, layer) {
+namespace {
+
+// Field numbers of the vector tile spec.
+enum : protozero::pbf_tag_type {
+    FeatureTags = 2,
+    LayerKeys = 3,
+    LayerValues = 4,
+};
+
+Value parseValue(const protozero::data_view& view) {
+    Value value;
+    protozero::pbf_reader reader(view);
+    while (reader.next()) {
+        switch (reader.tag()) {
+        case 1:
+            value = reader.get_string();
+            break;
+        case 2:
+            value = static_cast<double>(reader.get_float());
+            break;
+        case 3:
+            value = reader.get_double();
+            break;
+        case 4:
+            value = reader.get_int64();
+            break;
+        case 5:
+            value = reader.get_uint64();
+            break;
+        case 6:
+            value = reader.get_sint64();
+            break;
+        case 7:
+            value = reader.get_bool();
+            break;
+        default:
+            reader.skip();
+            break;
+        }
+    }
+    return value;
+}
+
+} // namespace
+
+VectorTileFeature::VectorTileFeature(const VectorTileLayer& layer_,
+                                     const protozero::data_view& view_)
+    : layer(layer_), view(view_), feature(view_, layer_.layer) {
 }
 
 FeatureType VectorTileFeature::getType() const {
@@ -22,7 +67,39 @@ FeatureType VectorTileFeature::getType() const {
 }
 
 optional<Value> VectorTileFeature::getValue(const std::string& key) const {
-    return feature.getValue(key);
+    auto it = layer.keyIDs.find(key);
+    if (it == layer.keyIDs.end()) {
+        return {};
+    }
+    return getValueByID(it->second);
+}
+
+optional<Value> VectorTileFeature::getValueByID(KeyID id) const {
+    if (!tags) {
+        tags = Tags();
+        protozero::pbf_reader reader(view);
+        while (reader.next(FeatureTags)) {
+            tags = reader.get_packed_uint32();
+        }
+    }
+
+    // Tags are pairs of indices into the layer's keys and values.
+    auto it = tags->begin();
+    const auto end = tags->end();
+    while (it != end) {
+        const uint32_t key = *it++;
+        if (it == end) {
+            break;
+        }
+        const uint32_t value = *it++;
+        if (key == id) {
+            if (value >= layer.values.size()) {
+                break;
+            }
+            return parseValue(layer.values[value]);
+        }
+    }
+    return {};
 }
 
 std::unordered_map<std::string, Value> VectorTileFeature::getProperties() const {
@@ -46,6 +123,22 @@ GeometryCollection VectorTileFeature::getGeometries() const {
 VectorTileLayer::VectorTileLayer(std::shared_ptr<const std::string> data_,
                                  const protozero::data_view& view)
     : data(std::move(data_)), layer(view) {
+    // Build our own dictionary, so that features can look properties up by key ID.
+    GeometryTileFeature::KeyID key = 0;
+    protozero::pbf_reader reader(view);
+    while (reader.next()) {
+        switch (reader.tag()) {
+        case LayerKeys:
+            keyIDs.emplace(reader.get_string(), key++);
+            break;
+        case LayerValues:
+            values.push_back(reader.get_view());
+            break;
+        default:
+            reader.skip();
+            break;
+        }
+    }
 }
 
 std::size_t VectorTileLayer::featureCount() const {
@@ -53,13 +146,17 @@ std::size_t VectorTileLayer::featureCount() const {
 }
 
 std::unique_ptr<GeometryTileFeature> VectorTileLayer::getFeature(std::size_t i) const {
-    return std::make_unique<VectorTileFeature>(layer, layer.getFeature(i));
+    return std::make_unique<VectorTileFeature>(*this, layer.getFeature(i));
 }
 
 std::string VectorTileLayer::getName() const {
     return layer.getName();
 }
 
+const std::unordered_map<std::string, GeometryTileFeature::KeyID>* VectorTileLayer::getKeyIDs() const {
+    return &keyIDs;
+}
+
 VectorTileData::VectorTileData(std::shared_ptr<const std::string> data_) : data(std::move(data_)) {
 }
 
@@ -9,18 +9,28 @@
 
 namespace mbgl {
 
+class VectorTileLayer;
+
 class VectorTileFeature : public GeometryTileFeature {
 public:
-    VectorTileFeature(const mapbox::vector_tile::layer&, const protozero::data_view&);
+    VectorTileFeature(const VectorTileLayer&, const protozero::data_view&);
 
     FeatureType getType() const override;
     optional<Value> getValue(const std::string& key) const override;
+    optional<Value> getValueByID(KeyID) const override;
     std::unordered_map<std::string, Value> getProperties() const override;
     optional<FeatureIdentifier> getID() const override;
     GeometryCollection getGeometries() const override;
 
 private:
+    using Tags = protozero::iterator_range<protozero::pbf_reader::const_uint32_iterator>;
+
+    const VectorTileLayer& layer;
+    const protozero::data_view view;
     mapbox::vector_tile::feature feature;
+
+    // Found the first time a property is looked up.
+    mutable optional<Tags> tags;
 };
 
 class VectorTileLayer : public GeometryTileLayer {
@@ -30,10 +40,15 @@ public:
     std::size_t featureCount() const override;
     std::unique_ptr<GeometryTileFeature> getFeature(std::size_t i) const override;
     std::string getName() const override;
+    const std::unordered_map<std::string, GeometryTileFeature::KeyID>* getKeyIDs() const override;
 
 private:
+    friend class VectorTileFeature;
+
     std::shared_ptr<const std::string> data;
     mapbox::vector_tile::layer layer;
+    std::unordered_map<std::string, GeometryTileFeature::KeyID> keyIDs;
+    std::vector<protozero::data_view> values;
 };
 
 class VectorTileData : public GeometryTileData {
@@ -28,11 +28,15 @@ namespace util {
 #undef compress
 
 std::string compress(const std::string &raw) {
+    return compress(raw, Z_DEFAULT_COMPRESSION);
+}
+
+std::string compress(const std::string &raw, int level) {
     z_stream deflate_stream;
     memset(&deflate_stream, 0, sizeof(deflate_stream));
 
     // TODO: reuse z_streams
-    if (deflateInit(&deflate_stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+    if (deflateInit(&deflate_stream, level) != Z_OK) {
         throw std::runtime_error("failed to initialize deflate");
     }
 
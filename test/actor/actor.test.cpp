@@ -7,6 +7,7 @@
 #include <functional>
 #include <future>
 #include <memory>
+#include <vector>
 
 using namespace mbgl;
 using namespace std::chrono_literals;
@@ -86,7 +87,7 @@ TEST(Actor, DestructionBlocksOnSend) {
             EXPECT_TRUE(waited.load());
         }
 
-        void schedule(std::weak_ptr<Mailbox>) final {
+        void schedule(std::weak_ptr<Mailbox>, Priority) final {
             promise.set_value();
             future.wait();
             std::this_thread::sleep_for(1ms);
@@ -282,6 +283,50 @@ TEST(Actor, NonConcurrentMailbox) {
     endedFuture.wait();
 }
 
+TEST(Actor, Priority) {
+    // Of the mailboxes waiting for a thread, the most urgent is received first.
+
+    struct Test {
+        Test(ActorRef<Test>) {}
+
+        void callMeBack(std::function<void ()> callback) {
+            callback();
+        }
+    };
+
+    ThreadPool pool { 1 };
+    std::vector<int> order;
+
+    std::promise<void> started;
+    std::promise<void> unblock;
+    std::shared_future<void> unblocked = unblock.get_future();
+    Actor<Test> blocker(pool);
+    blocker.invoke(&Test::callMeBack, [&] {
+        started.set_value();
+        unblocked.wait();
+    });
+    started.get_future().wait();
+
+    Actor<Test> low(pool);
+    Actor<Test> high(pool);
+    Actor<Test> normal(pool);
+    low.setPriority(20);
+    high.setPriority(Scheduler::defaultPriority);
+    normal.setPriority(10);
+
+    low.invoke(&Test::callMeBack, [&] { order.push_back(1); });
+    high.invoke(&Test::callMeBack, [&] { order.push_back(2); });
+    normal.invoke(&Test::callMeBack, [&] { order.push_back(3); });
+
+    std::promise<void> done;
+    blocker.setPriority(30);
+    blocker.invoke(&Test::callMeBack, [&] { done.set_value(); });
+    unblock.set_value();
+    done.get_future().wait();
+
+    EXPECT_EQ((std::vector<int>{ 2, 3, 1 }), order);
+}
+
 TEST(Actor, Ask) {
     // Asking for a result
 
@@ -0,0 +1,129 @@
+#include <mbgl/actor/mailbox.hpp>
+#include <mbgl/actor/message.hpp>
+#include <mbgl/util/default_thread_pool.hpp>
+
+#include <mbgl/test/util.hpp>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+// Runs a function when received, and counts the messages that are alive.
+class TestMessage : public Message {
+public:
+    TestMessage(std::atomic<int>& alive_, std::function<void ()> fn_)
+        : alive(alive_), fn(std::move(fn_)) {
+        alive++;
+    }
+
+    ~TestMessage() override {
+        alive--;
+    }
+
+    void operator()() override {
+        fn();
+    }
+
+private:
+    std::atomic<int>& alive;
+    std::function<void ()> fn;
+};
+
+} // namespace
+
+TEST(Mailbox, OrderedPerProducer) {
+    // Messages of one producer are received in the order it sent them, however
+    // many producers send concurrently.
+
+    const int producers = 4;
+    const int messages = 1000;
+
+    // Only touched by the receiver, which is never concurrent with itself.
+    std::vector<int> last(producers, -1);
+    int received = 0;
+    std::promise<void> done;
+    std::atomic<int> alive { 0 };
+
+    {
+        ThreadPool pool { 4 };
+        auto mailbox = std::make_shared<Mailbox>(pool);
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] () {
+                for (int i = 0; i < messages; ++i) {
+                    mailbox->push(std::make_unique<TestMessage>(alive, [&, p, i] () {
+                        EXPECT_EQ(last[p] + 1, i);
+                        last[p] = i;
+                        if (++received == producers * messages) {
+                            done.set_value();
+                        }
+                    }));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        done.get_future().wait();
+        mailbox->close();
+        for (int p = 0; p < producers; ++p) {
+            EXPECT_EQ(messages - 1, last[p]);
+        }
+    }
+
+    // The pool's threads may hold on to the mailbox until they are joined.
+    EXPECT_EQ(0, alive);
+}
+
+TEST(Mailbox, CloseRacingPush) {
+    // Once close() returns, no message is received any more, and the messages
+    // that weren't received are freed with the mailbox.
+
+    for (int run = 0; run < 50; ++run) {
+        std::atomic<bool> closed { false };
+        std::atomic<bool> stop { false };
+        std::atomic<int> alive { 0 };
+        std::atomic<int> late { 0 };
+
+        {
+            ThreadPool pool { 2 };
+            auto mailbox = std::make_shared<Mailbox>(pool);
+
+            std::vector<std::thread> threads;
+            for (int p = 0; p < 3; ++p) {
+                threads.emplace_back([&] () {
+                    while (!stop) {
+                        mailbox->push(std::make_unique<TestMessage>(alive, [&] () {
+                            if (closed) {
+                                late++;
+                            }
+                        }));
+                    }
+                });
+            }
+
+            std::this_thread::yield();
+            mailbox->close();
+            closed = true;
+
+            // Pushes after close() are dropped at once.
+            std::this_thread::yield();
+            stop = true;
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+        EXPECT_EQ(0, late);
+        EXPECT_EQ(0, alive);
+    }
+}
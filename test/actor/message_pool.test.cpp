@@ -0,0 +1,73 @@
+#include <mbgl/actor/message_pool.hpp>
+
+#include <mbgl/test/util.hpp>
+
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace mbgl;
+
+TEST(MessagePool, Reuse) {
+    // Freed blocks are reused for messages of the same size class.
+
+    MessagePool pool;
+
+    void* block = MessagePool::allocate(100);
+    MessagePool::deallocate(block, 100);
+    EXPECT_EQ(block, MessagePool::allocate(128));
+    MessagePool::deallocate(block, 128);
+}
+
+TEST(MessagePool, FreedOnAnotherThread) {
+    // Messages are allocated by the sender and freed by the receiver, on the
+    // receiver's pool. Its thread reuses them, and they outlive the sender's
+    // pool.
+
+    std::vector<void*> blocks;
+    std::thread([&] () {
+        MessagePool pool;
+        for (int i = 0; i < 16; ++i) {
+            blocks.push_back(MessagePool::allocate(48));
+            std::memset(blocks.back(), i, 48);
+        }
+    }).join();
+
+    std::thread([&] () {
+        MessagePool pool;
+        for (void* block : blocks) {
+            MessagePool::deallocate(block, 48);
+        }
+
+        const std::set<void*> freed(blocks.begin(), blocks.end());
+        std::vector<void*> reused;
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            reused.push_back(MessagePool::allocate(64));
+            EXPECT_EQ(1u, freed.count(reused.back()));
+            std::memset(reused.back(), 0, 64);
+        }
+        for (void* block : reused) {
+            MessagePool::deallocate(block, 64);
+        }
+    }).join();
+}
+
+TEST(MessagePool, Oversized) {
+    // Messages larger than the largest size class bypass the pool.
+
+    MessagePool pool;
+
+    void* block = MessagePool::allocate(600);
+    std::memset(block, 0, 600);
+    MessagePool::deallocate(block, 600);
+    void* largest = MessagePool::allocate(512);
+    EXPECT_NE(block, largest);
+    MessagePool::deallocate(largest, 512);
+
+    // Without a pool, every size comes from the heap.
+    std::thread([] () {
+        void* unpooled = MessagePool::allocate(64);
+        MessagePool::deallocate(unpooled, 64);
+    }).join();
+}
@@ -258,6 +258,71 @@ TEST(OfflineDatabase, PutTileNotFound) {
     EXPECT_FALSE(res->data.get());
 }
 
+TEST(OfflineDatabase, PutTileCompressionPolicy) {
+    using namespace mbgl;
+
+    OfflineDatabase db(":memory:");
+
+    Resource resource { Resource::Tile, "http://example.com/" };
+    resource.tileData = Resource::TileData {
+        "http://example.com/",
+        1,
+        0,
+        0,
+        0
+    };
+    Response response;
+
+    // Already compressed formats are stored as is, even if they'd deflate well.
+    response.data = std::make_shared<std::string>("\x89PNG\r\n\x1a\n"s + std::string(1024, '0'));
+    EXPECT_EQ(OfflineDatabase::CompressionPolicy::Auto, db.getCompressionPolicy(Resource::Tile));
+    EXPECT_EQ(response.data->size(), db.put(resource, response).second);
+
+    db.setCompressionPolicy(Resource::Tile, OfflineDatabase::CompressionPolicy::Always);
+    EXPECT_GT(response.data->size(), db.put(resource, response).second);
+    EXPECT_EQ(*response.data, *db.get(resource)->data);
+
+    // Anything else is compressed unless the policy says otherwise.
+    response.data = std::make_shared<std::string>(std::string(1024, '0'));
+    db.setCompressionPolicy(Resource::Tile, OfflineDatabase::CompressionPolicy::Auto);
+    EXPECT_GT(response.data->size(), db.put(resource, response).second);
+
+    db.setCompressionPolicy(Resource::Tile, OfflineDatabase::CompressionPolicy::Never);
+    EXPECT_EQ(response.data->size(), db.put(resource, response).second);
+    EXPECT_EQ(*response.data, *db.get(resource)->data);
+}
+
+TEST(OfflineDatabase, PutBatch) {
+    using namespace mbgl;
+
+    OfflineDatabase db(":memory:");
+
+    std::vector<std::pair<Resource, Response>> entries;
+    for (int32_t x = 0; x < 3; x++) {
+        Response response;
+        response.data = std::make_shared<std::string>("tile " + util::toString(x));
+        entries.emplace_back(Resource::tile("http://example.com/{z}/{x}/{y}", 1, x, 0, 1, Tileset::Scheme::XYZ), response);
+    }
+    entries.emplace_back(Resource::style("http://example.com/"), entries.front().second);
+
+    auto results = db.putBatch(entries);
+    ASSERT_EQ(4u, results.size());
+    for (const auto& result : results) {
+        EXPECT_TRUE(result.first);
+        EXPECT_EQ(6u, result.second);
+    }
+
+    for (const auto& entry : entries) {
+        auto res = db.get(entry.first);
+        ASSERT_TRUE(bool(res));
+        EXPECT_EQ(*entry.second.data, *res->data);
+    }
+
+    // Existing entries are updated in place.
+    results = db.putBatch(entries);
+    EXPECT_FALSE(results.front().first);
+}
+
 TEST(OfflineDatabase, CreateRegion) {
     using namespace mbgl;
 
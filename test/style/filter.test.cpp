@@ -4,6 +4,7 @@
 
 #include <mbgl/style/filter.hpp>
 #include <mbgl/style/filter_evaluator.hpp>
+#include <mbgl/style/compiled_filter.hpp>
 #include <mbgl/style/conversion/json.hpp>
 #include <mbgl/style/conversion/filter.hpp>
 
@@ -121,3 +122,61 @@ TEST(Filter, ID) {
 
     ASSERT_FALSE(parse("[\"==\", \"$id\", 1234]")(feature2));
 }
+
+TEST(Filter, Compiled) {
+    const std::vector<const char*> filters = {
+        R"(["==", "foo", 0])",
+        R"(["!=", "foo", "bar"])",
+        R"(["<", "foo", 1])",
+        R"([">=", "foo", 1])",
+        R"(["in", "foo", 0, "1", true])",
+        R"(["!in", "foo", 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, "bar", false])",
+        R"(["in", "foo", 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, "bar", false])",
+        // Integers above 2^53 are distinct, but not as doubles.
+        R"(["in", "foo", 9007199254740993, 1, 2, 3, 4, 5, 6, 7, 8])",
+        R"(["in", "foo", -9007199254740993, 1, 2, 3, 4, 5, 6, 7, 8])",
+        R"(["in", "foo", 9007199254740992, 1, 2, 3, 4, 5, 6, 7, 8])",
+        R"(["has", "foo"])",
+        R"(["!has", "foo"])",
+        R"(["in", "$type", "LineString", "Polygon"])",
+        R"(["!=", "$type", "Point"])",
+        R"(["in", "$id", 1234, "1234"])",
+        R"(["!has", "$id"])",
+        R"(["any"])",
+        R"(["all"])",
+        R"(["none"])",
+        R"(["all", ["has", "foo"], ["any", ["==", "foo", 1], ["==", "bar", "baz"]]])",
+        R"(["none", [">", "foo", 0], ["!=", "bar", "baz"], ["==", "$type", "Polygon"]])",
+    };
+
+    std::vector<Feature> features = {
+        feature({{}}),
+        feature({{ "foo", int64_t(0) }}),
+        feature({{ "foo", uint64_t(1) }}),
+        feature({{ "foo", double(-0.0) }}),
+        feature({{ "foo", double(5) }, { "bar", std::string("baz") }}, LineString<double>()),
+        feature({{ "foo", std::string("1") }}, Polygon<double>()),
+        feature({{ "foo", std::string("bar") }}),
+        feature({{ "foo", false }}),
+        feature({{ "foo", uint64_t(1) << 53 }}),
+        feature({{ "foo", (uint64_t(1) << 53) + 1 }}),
+        feature({{ "foo", -(int64_t(1) << 53) }}),
+        feature({{ "foo", double(uint64_t(1) << 53) }}),
+        feature({{ "foo", true }, { "bar", std::string("qux") }}),
+    };
+    features.back().id = { uint64_t(1234) };
+
+    for (const char* expression : filters) {
+        const Filter filter = parse(expression);
+        const CompiledFilter compiled(filter);
+        for (const auto& f : features) {
+            EXPECT_EQ(filter(f),
+                      compiled(apply_visitor(ToFeatureType(), f.geometry), f.id, [&] (const std::string& key) -> optional<Value> {
+                          auto it = f.properties.find(key);
+                          if (it == f.properties.end())
+                              return {};
+                          return it->second;
+                      })) << expression;
+        }
+    }
+}
@@ -1,9 +1,11 @@
 #include <mbgl/test/util.hpp>
 #include <mbgl/test/fake_file_source.hpp>
 #include <mbgl/tile/vector_tile.hpp>
+#include <mbgl/tile/vector_tile_data.hpp>
 #include <mbgl/tile/tile_loader_impl.hpp>
 
 #include <mbgl/util/default_thread_pool.hpp>
+#include <mbgl/util/io.hpp>
 #include <mbgl/util/run_loop.hpp>
 #include <mbgl/map/transform.hpp>
 #include <mbgl/style/style.hpp>
@@ -106,3 +108,24 @@ TEST(VectorTile, Issue8542) {
     std::vector<Feature> result;
     tile.querySourceFeatures(result, { { {"layer"} }, {} });
 }
+
+TEST(VectorTile, KeyIDs) {
+    // Looking properties up by key ID finds the same values as decoding them all.
+    VectorTileData data(std::make_shared<std::string>(
+        util::read_file("test/fixtures/api/assets/streets/10-163-395.vector.pbf")));
+
+    for (const auto& name : data.layerNames()) {
+        auto layer = data.getLayer(name);
+        ASSERT_TRUE(layer);
+        GeometryTileLayerKeys keys(*layer);
+
+        for (std::size_t i = 0; i < layer->featureCount(); i++) {
+            auto feature = layer->getFeature(i);
+            for (const auto& property : feature->getProperties()) {
+                EXPECT_EQ(property.second, *feature->getValue(property.first));
+                EXPECT_EQ(property.second, *keys.getValue(*feature, property.first));
+            }
+            EXPECT_FALSE(keys.getValue(*feature, "no such key"));
+        }
+    }
+}
@@ -3,6 +3,7 @@
 #include <mbgl/util/premultiply.hpp>
 #include <mbgl/util/image.hpp>
 #include <mbgl/util/io.hpp>
+#include <mbgl/util/png_encoder.hpp>
 
 using namespace mbgl;
 
@@ -34,6 +35,50 @@ TEST(Image, PNGRoundTripAlpha) {
     EXPECT_EQ(128, image.data[3]);
 }
 
+#if !defined(__QT__)
+TEST(Image, PNGEncoderFilters) {
+    const PremultipliedImage tile = decodeImage(util::read_file("test/fixtures/image/tile.png"));
+
+    for (auto filter : { PNGEncoder::Filter::None, PNGEncoder::Filter::Sub, PNGEncoder::Filter::Up,
+                         PNGEncoder::Filter::Paeth, PNGEncoder::Filter::Adaptive }) {
+        PNGEncoder::Options options;
+        options.level = 1;
+        options.filter = filter;
+        PNGEncoder encoder(options);
+
+        // Encode twice to make sure the reused buffers don't leak between images.
+        encoder.encode(tile);
+        PremultipliedImage image = decodeImage(encoder.encode(tile));
+        ASSERT_EQ(tile.size, image.size);
+        EXPECT_EQ(0, std::memcmp(tile.data.get(), image.data.get(), tile.bytes()));
+    }
+}
+
+TEST(Image, PNGEncoderPalette) {
+    PremultipliedImage rgba({ 3, 1 });
+    const uint8_t pixels[12] = { 128, 0, 0, 255, 0, 0, 0, 0, 64, 0, 0, 128 };
+    std::memcpy(rgba.data.get(), pixels, 12);
+
+    PNGEncoder::Options options;
+    options.palette = true;
+    const std::string png = PNGEncoder(options).encode(rgba);
+
+    // Color type 3 is a palette image.
+    EXPECT_EQ(3, png[25]);
+    PremultipliedImage image = decodeImage(png);
+    EXPECT_EQ(0, std::memcmp(pixels, image.data.get(), 12));
+}
+
+TEST(Image, PNGEncoderQuantize) {
+    const PremultipliedImage tile = decodeImage(util::read_file("test/fixtures/image/tile.png"));
+
+    PNGEncoder::Options options;
+    options.palette = true;
+    PremultipliedImage image = decodeImage(PNGEncoder(options).encode(tile));
+    ASSERT_EQ(tile.size, image.size);
+}
+#endif // !defined(__QT__)
+
 TEST(Image, PNGReadNoProfile) {
     PremultipliedImage image = decodeImage(util::read_file("test/fixtures/image/no_profile.png"));
     EXPECT_EQ(128, image.data[0]);
@@ -79,6 +124,37 @@ TEST(Image, JPEGTile) {
 }
 
 #if !defined(__ANDROID__) && !defined(__APPLE__) && !defined(QT_IMAGE_DECODERS)
+TEST(Image, JPEGRoundTrip) {
+    PremultipliedImage rgba({ 16, 16 });
+    for (size_t i = 0; i < rgba.bytes(); i += 4) {
+        rgba.data[i + 0] = 128;
+        rgba.data[i + 1] = 64;
+        rgba.data[i + 2] = 0;
+        rgba.data[i + 3] = 255;
+    }
+
+    PremultipliedImage image = decodeImage(encodeJPEG(rgba, 95));
+    ASSERT_EQ(rgba.size, image.size);
+    EXPECT_NEAR(128, image.data[0], 2);
+    EXPECT_NEAR(64, image.data[1], 2);
+    EXPECT_NEAR(0, image.data[2], 2);
+    EXPECT_EQ(255, image.data[3]);
+}
+
+TEST(Image, WebPRoundTripLossless) {
+    PremultipliedImage rgba({ 1, 1 });
+    rgba.data[0] = 128;
+    rgba.data[1] = 0;
+    rgba.data[2] = 0;
+    rgba.data[3] = 128;
+
+    PremultipliedImage image = decodeImage(encodeWebP(rgba, 100, true));
+    EXPECT_EQ(128, image.data[0]);
+    EXPECT_EQ(0, image.data[1]);
+    EXPECT_EQ(0, image.data[2]);
+    EXPECT_EQ(128, image.data[3]);
+}
+
 TEST(Image, WebPTile) {
     PremultipliedImage image = decodeImage(util::read_file("test/fixtures/image/tile.webp"));
     EXPECT_EQ(256u, image.size.width);
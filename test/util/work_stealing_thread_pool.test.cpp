@@ -0,0 +1,112 @@
+#include <mbgl/actor/actor.hpp>
+#include <mbgl/util/work_stealing_thread_pool.hpp>
+
+#include <mbgl/test/util.hpp>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+
+using namespace mbgl;
+
+TEST(WorkStealingThreadPool, ReceivesInOrder) {
+    // Messages to one actor are received one at a time and in order, even
+    // when they're sent from the pool's own threads and stolen by others.
+
+    struct Counter {
+        Counter(ActorRef<Counter>, std::promise<void> done_)
+            : done(std::move(done_)) {
+        }
+
+        void receive(std::size_t n) {
+            EXPECT_FALSE(busy.exchange(true));
+            EXPECT_EQ(next, n);
+            next++;
+            busy = false;
+            if (next == 10000) {
+                done.set_value();
+            }
+        }
+
+        std::atomic<bool> busy { false };
+        std::size_t next = 0;
+        std::promise<void> done;
+    };
+
+    struct Sender {
+        Sender(ActorRef<Sender>, ActorRef<Counter> counter_)
+            : counter(std::move(counter_)) {
+        }
+
+        void send(std::size_t from, std::size_t to) {
+            for (std::size_t n = from; n < to; ++n) {
+                counter.invoke(&Counter::receive, n);
+            }
+        }
+
+        ActorRef<Counter> counter;
+    };
+
+    WorkStealingThreadPool pool { 4 };
+
+    std::promise<void> promise;
+    std::future<void> done = promise.get_future();
+    Actor<Counter> counter(pool, std::move(promise));
+    Actor<Sender> sender(pool, counter.self());
+
+    for (std::size_t n = 0; n < 10000; n += 100) {
+        sender.invoke(&Sender::send, n, n + 100);
+    }
+
+    done.wait();
+}
+
+TEST(WorkStealingThreadPool, FanOut) {
+    // More mailboxes than fit in a thread's deque are all received.
+
+    struct Test {
+        Test(ActorRef<Test>, std::atomic<std::size_t>& received_, std::promise<void>& done_)
+            : received(received_), done(done_) {
+        }
+
+        void receive() {
+            if (++received == 5000) {
+                done.set_value();
+            }
+        }
+
+        std::atomic<std::size_t>& received;
+        std::promise<void>& done;
+    };
+
+    struct Spawner {
+        Spawner(ActorRef<Spawner>, std::vector<std::unique_ptr<Actor<Test>>>& actors_)
+            : actors(actors_) {
+        }
+
+        void spawn() {
+            for (auto& actor : actors) {
+                actor->invoke(&Test::receive);
+            }
+        }
+
+        std::vector<std::unique_ptr<Actor<Test>>>& actors;
+    };
+
+    WorkStealingThreadPool pool { 4 };
+
+    std::atomic<std::size_t> received { 0 };
+    std::promise<void> promise;
+    std::future<void> done = promise.get_future();
+
+    std::vector<std::unique_ptr<Actor<Test>>> actors;
+    for (std::size_t i = 0; i < 5000; ++i) {
+        actors.push_back(std::make_unique<Actor<Test>>(pool, received, promise));
+    }
+
+    Actor<Spawner> spawner(pool, actors);
+    spawner.invoke(&Spawner::spawn);
+
+    done.wait();
+}